@@ -0,0 +1,125 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+// std
+#include <vector>
+
+#ifndef DEMO_CONFIG_BENCHMARK
+#	define DEMO_CONFIG_BENCHMARK 0
+#endif // DEMO_CONFIG_BENCHMARK
+
+namespace demo
+{
+	struct BenchmarkSystem
+	{
+		enum Enum
+		{
+			Camera,
+			Input,
+			Movement,
+			Render,
+
+			Count
+		};
+	};
+
+	// Gamepad state of one frame of the benchmark script.
+	struct BenchmarkInput
+	{
+		I32 leftX; // Raw axis values
+		I32 leftY;
+		I32 rightX;
+		I32 rightY;
+		bool shoulderLeft;
+		bool shoulderRight;
+	};
+
+	// Same input for the same frame on every run, walks and turns in changing directions and toggles
+	// the shoulder buttons now and then.
+	void benchmarkGetInput(BenchmarkInput& _input, U32 _frame);
+
+	// Heap allocations made so far, counted by the global operator new. Only counted in benchmark builds.
+	U64 benchmarkGetNumAllocations();
+
+	// Returns the value following _name on the command line, NULL if either is missing.
+	const char* benchmarkGetArg(I32 _argc, const char* const* _argv, const char* _name);
+	bool benchmarkHasArg(I32 _argc, const char* const* _argv, const char* _name);
+
+	// Nearest rank percentile, sorts _values.
+	F64 benchmarkPercentile(std::vector<F64>& _values, F64 _percent);
+
+	// Per system timing of the headless benchmark build (DEMO_CONFIG_BENCHMARK). The demo runs with the
+	// null renderer and scripted input for a fixed number of frames, warmup frames aren't recorded.
+	class SystemBenchmark
+	{
+	public:
+		SystemBenchmark();
+
+		void init(U32 _numEntities, U32 _numWarmupFrames, U32 _numFrames);
+
+		void beginFrame();
+		void endFrame();
+
+		void beginSystem(BenchmarkSystem::Enum _system);
+		void endSystem(BenchmarkSystem::Enum _system);
+
+		// Frame being simulated, counting warmup frames.
+		U32 getFrame() const { return m_frame; }
+		bool isDone() const { return m_frame >= m_numWarmupFrames + m_numFrames; }
+
+		bool writeJson(const base::FilePath& _filePath) const;
+		void printSummary() const;
+
+	private:
+		struct Frame
+		{
+			I64 systemTicks[BenchmarkSystem::Count];
+			U64 systemAllocations[BenchmarkSystem::Count];
+			I64 totalTicks;
+			U64 numAllocations;
+		};
+
+		bool isRecording() const { return m_frame >= m_numWarmupFrames && !isDone(); }
+
+		std::vector<Frame> m_frames;
+		Frame m_current;
+		I64 m_systemStart[BenchmarkSystem::Count];
+		U64 m_systemStartAllocations[BenchmarkSystem::Count];
+		I64 m_frameStart;
+		U64 m_frameStartAllocations;
+		U32 m_numEntities;
+		U32 m_numWarmupFrames;
+		U32 m_numFrames;
+		U32 m_frame;
+	};
+
+	// Times a system while in scope.
+	class SystemBenchmarkScope
+	{
+	public:
+		SystemBenchmarkScope(SystemBenchmark& _benchmark, BenchmarkSystem::Enum _system)
+			: m_benchmark(_benchmark)
+			, m_system(_system)
+		{
+			m_benchmark.beginSystem(m_system);
+		}
+
+		~SystemBenchmarkScope()
+		{
+			m_benchmark.endSystem(m_system);
+		}
+
+	private:
+		SystemBenchmark& m_benchmark;
+		BenchmarkSystem::Enum m_system;
+	};
+
+} // namespace demo
+
+#if DEMO_CONFIG_BENCHMARK
+#	define DEMO_BENCHMARK_SCOPE(_benchmark, _system) demo::SystemBenchmarkScope BASE_CONCATENATE(benchmarkScope, __LINE__)(_benchmark, _system)
+#else
+#	define DEMO_BENCHMARK_SCOPE(_benchmark, _system) BASE_NOOP()
+#endif // DEMO_CONFIG_BENCHMARK
@@ -0,0 +1,35 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+// std
+#include <string>
+#include <vector>
+
+namespace demo
+{
+	// Reports files in a directory that were rewritten or replaced, for reloading assets while running.
+	// Uses inotify on Linux, init fails on other platforms.
+	class FileWatcher
+	{
+	public:
+		FileWatcher();
+		~FileWatcher();
+
+		// Returns false if the directory can't be watched.
+		bool init(const char* _dir);
+		void shutdown();
+
+		// Returns true once for every time _name was closed after writing or moved into the directory.
+		// Never blocks, pending events are read on every call.
+		bool hasChanged(const char* _name);
+
+	private:
+		void readEvents();
+
+		std::vector<std::string> m_changed; // Names written since they were last asked for
+		int m_fd;
+	};
+
+} // namespace demo
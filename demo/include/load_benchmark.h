@@ -0,0 +1,53 @@
+#pragma once
+
+#include "benchmark.h"
+#include "pakx_reader.h"
+
+namespace demo
+{
+	struct PakLoadStage
+	{
+		enum Enum
+		{
+			Open, // mara::loadPak, opening the file and reading its table of contents
+			Load, // mara::loadPrefab, finding the entries and decoding them
+			Create, // mara::createPrefab, creating GPU resources
+			Run, // All of the above for a whole PAK
+
+			Count
+		};
+	};
+
+	// Writes a PAK of generated prefabs for the load benchmark. Every prefab has one mesh with its own
+	// geometry, the geometry is spread evenly over _totalBytes. All meshes share one material, its
+	// shaders are copied from the program table of _shaders so the PAK needs nothing else loaded. Must
+	// run in a process of its own before anything is loaded, createPak packs every loaded resource.
+	bool generateBenchmarkPak(const base::FilePath& _filePath, U32 _numEntries, U64 _totalBytes, PakxReader& _shaders);
+
+	// Prefabs generateBenchmarkPak writes for _numEntries entries.
+	U32 getNumBenchmarkPrefabs(U32 _numEntries);
+
+	// Drops the file from the page cache so the next read goes to disk. Returns false where the platform
+	// can't do it.
+	bool dropFileCache(const char* _path);
+
+	// Times loading a PAK made by generateBenchmarkPak, repeated so the report has percentiles. Cold
+	// runs drop the PAK from the page cache first, if the platform can't every run is warm.
+	class PakLoadBenchmark
+	{
+	public:
+		PakLoadBenchmark();
+
+		void run(const base::FilePath& _filePath, U32 _numEntries, U32 _numRuns, bool _isCold);
+
+		bool writeJson(const base::FilePath& _filePath) const;
+		void printSummary() const;
+
+	private:
+		std::vector<F64> m_samplesMs[PakLoadStage::Count]; // Open and Run once per run, others once per prefab
+		U32 m_numEntries;
+		U32 m_numRuns;
+		bool m_isCold; // Requested and supported, decided before the first run
+	};
+
+} // namespace demo
@@ -0,0 +1,26 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+// shared
+#include <pakx.h>
+
+namespace demo
+{
+	struct Frustum
+	{
+		F32 planes[6][4]; // Normalized planes pointing inwards, xyz normal and w distance
+	};
+
+	// Extracts frustum planes from a row vector view projection matrix.
+	void buildFrustum(Frustum& _frustum, const F32* _viewProj, bool _homogeneousDepth);
+
+	bool isSphereVisible(const Frustum& _frustum, const base::Vec3& _center, F32 _radius);
+
+	// Tests meshlets against the frustum and their normal cones against the camera position.
+	// _mtx transforms mesh space to world space. Returns the number of visible meshlets.
+	U32 cullMeshlets(const pakx::Meshlet* _meshlets, U32 _numMeshlets, const F32* _mtx, const Frustum& _frustum,
+		const base::Vec3& _cameraPosition, bool _coneCulling);
+
+} // namespace demo
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "pakx_reader.h"
+
+// std
+#include <vector>
+
+namespace demo
+{
+	// Blend shape state of one drawn copy of a mesh.
+	struct MorphInstance
+	{
+		MorphInstance();
+
+		graphics::TextureHandle texture; // Summed deltas, one texel per vertex
+		U16 width;
+		U16 height;
+		U32 numVertices; // Vertices moved by any target, the rest are never fetched
+		std::vector<F32> weights; // One per target of the mesh, set by the game
+		std::vector<F32> appliedWeights; // Weights the texture was last built with
+		bool isActive; // Any weight is non-zero
+	};
+
+	// Blend shapes from the .pakx. Deltas stay sparse on the CPU. Every drawn mesh sums the deltas of its
+	// targets with a non-zero weight into its own texture, which the morph vertex shader adds to the
+	// position. The texture is only rebuilt when weights change.
+	class MorphTargets
+	{
+	public:
+		struct Stats
+		{
+			U32 numTargets;
+			U32 numDeltas;
+			U32 numEvaluatedTargets; // This frame
+			U32 numEvaluatedDeltas;
+			U32 numUploads;
+		};
+
+		MorphTargets();
+		~MorphTargets();
+
+		bool init(PakxReader* _reader);
+		void shutdown();
+
+		// Returns false if the mesh has no targets.
+		bool createInstance(MorphInstance& _instance, const pakx::Mesh& _record) const;
+		void destroyInstance(MorphInstance& _instance) const;
+
+		void update(MorphInstance& _instance, const pakx::Mesh& _record);
+
+		// Binds deltas for the next draw, _uniform receives vertex count and texture width.
+		void bind(U8 _stage, graphics::UniformHandle _sampler, graphics::UniformHandle _uniform, const MorphInstance& _instance) const;
+
+		// Starts a new frame of stats.
+		void resetStats();
+
+		const Stats& getStats() const { return m_stats; }
+
+	private:
+		std::vector<pakx::MorphTarget> m_targets;
+		std::vector<pakx::MorphDelta> m_deltas;
+		std::vector<F32> m_sum;
+		std::vector<U16> m_texels;
+		Stats m_stats;
+	};
+
+} // namespace demo
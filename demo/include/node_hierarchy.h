@@ -0,0 +1,41 @@
+#pragma once
+
+#include "pakx_reader.h"
+
+namespace demo
+{
+	// Node transforms of one prefab instance. Local transforms are copied from the .pakx as they are,
+	// parents come before their children so world transforms resolve in one pass over the nodes.
+	class NodeHierarchy
+	{
+	public:
+		NodeHierarchy();
+		~NodeHierarchy();
+
+		// _nodes is the prefab's block from PakxReader::getNodes, the parents stay shared with it.
+		void init(const void* _nodes, U32 _numNodes);
+		void shutdown();
+
+		// Local transforms, call setDirty after changing them.
+		F32* getTranslation(U32 _node) { return &m_locals[_node * 3]; }
+		F32* getRotation(U32 _node) { return &m_locals[m_numNodes * 3 + _node * 4]; }
+		F32* getScale(U32 _node) { return &m_locals[m_numNodes * 7 + _node * 3]; }
+		void setDirty() { m_isDirty = true; }
+
+		// Resolves world transforms if any local transform changed since the last update.
+		void update();
+
+		// Node to prefab space, row vector. Valid after update.
+		const F32* getWorld(U32 _node) const { return &m_worlds[_node * 16]; }
+
+		U32 getNumNodes() const { return m_numNodes; }
+
+	private:
+		const U32* m_parents;
+		F32* m_locals; // Translations, rotations and scales, same layout as the nodes chunk
+		F32* m_worlds;
+		U32 m_numNodes;
+		bool m_isDirty;
+	};
+
+} // namespace demo
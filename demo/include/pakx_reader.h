@@ -0,0 +1,67 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+// shared
+#include <pakx.h>
+
+// std
+#include <mutex>
+#include <vector>
+
+namespace demo
+{
+	// Runtime side of the .pakx sidecar written by the resource compiler.
+	class PakxReader
+	{
+	public:
+		PakxReader();
+		~PakxReader();
+
+		bool open(const base::FilePath& _filePath);
+		void close();
+		bool isOpen() const { return m_isOpen; }
+		bool hasChunk(U32 _fourcc) const { return NULL != findChunk(_fourcc); }
+
+		// Reads a range of a chunk straight from disk. Safe to call from any thread.
+		bool read(U32 _fourcc, U32 _offset, void* _dst, U32 _size);
+
+		// Returns the mesh records of a prefab, in the same order as the prefab's meshes.
+		const pakx::Mesh* findPrefabMeshes(U32 _vfpHash, U32* _outNum) const;
+
+		// Returns the prefab entry, NULL if the prefab isn't in the sidecar.
+		const pakx::Prefab* findPrefab(U32 _vfpHash) const;
+
+		// Returns every prefab in the sidecar.
+		const pakx::Prefab* getPrefabs(U32* _outNum) const
+		{
+			*_outNum = (U32)m_prefabs.size();
+			return m_prefabs.data();
+		}
+
+		// Returns the node block of a prefab, laid out as described in pakx.h. NULL if it has no nodes.
+		const void* getNodes(const pakx::Prefab& _prefab) const;
+
+		// Returns the meshlets of a mesh record, NULL if it has none.
+		const pakx::Meshlet* getMeshlets(const pakx::Mesh& _record) const;
+
+		// Returns the packed uniform block of a material, NULL if out of range.
+		const pakx::MaterialBlock* getMaterial(U32 _index) const;
+
+	private:
+		const pakx::Chunk* findChunk(U32 _fourcc) const;
+
+		base::FileReader m_reader;
+		std::mutex m_mutex;
+		bool m_isOpen;
+
+		std::vector<pakx::Chunk> m_chunks;
+		std::vector<pakx::Prefab> m_prefabs;
+		std::vector<pakx::Mesh> m_meshes;
+		std::vector<pakx::Meshlet> m_meshlets;
+		std::vector<U8> m_nodes; // Whole nodes chunk
+		std::vector<pakx::MaterialBlock> m_materials;
+	};
+
+} // namespace demo
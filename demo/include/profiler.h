@@ -0,0 +1,73 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+#ifndef DEMO_CONFIG_PROFILER
+#	define DEMO_CONFIG_PROFILER 1
+#endif // DEMO_CONFIG_PROFILER
+
+namespace demo
+{
+	// CPU frame profiler.
+	//
+	// Zones are recorded when a scope ends into a ring buffer owned by the recording thread, so
+	// recording never locks. The main thread marks frames and reads the buffers for the live view
+	// and for exporting captures in Chrome trace format (chrome://tracing, ui.perfetto.dev).
+	struct ProfilerZone
+	{
+		const char* name; // Must be a string literal
+		I64 begin;
+		I64 end;
+		U16 thread;
+		U16 depth;
+	};
+
+	void profilerSetThreadName(const char* _name);
+
+	// Called by the main thread at the start of every frame.
+	void profilerBeginFrame();
+
+	// Frees all thread buffers, every thread that recorded zones must have finished.
+	void profilerShutdown();
+
+	// Zones of the main thread in the last completed frame, sorted by begin time.
+	U32 profilerGetLastFrame(ProfilerZone* _zones, U32 _maxZones, I64* _outFrameBegin, I64* _outFrameEnd);
+
+	// Duration of a recent frame, 0 is the last completed frame.
+	F64 profilerGetFrameTimeMs(U32 _framesAgo);
+	U32 profilerGetNumFrameTimes();
+
+	// Writes every zone still in the ring buffers of all threads.
+	bool profilerExportChromeTrace(const base::FilePath& _filePath);
+
+	U16 profilerPushZone();
+	void profilerPopZone(const char* _name, I64 _begin, U16 _depth);
+
+	class ProfilerScope
+	{
+	public:
+		ProfilerScope(const char* _name)
+			: m_name(_name)
+			, m_depth(profilerPushZone())
+			, m_begin(base::getHPCounter())
+		{}
+
+		~ProfilerScope()
+		{
+			profilerPopZone(m_name, m_begin, m_depth);
+		}
+
+	private:
+		const char* m_name;
+		U16 m_depth;
+		I64 m_begin;
+	};
+
+} // namespace demo
+
+#if DEMO_CONFIG_PROFILER
+#	define DEMO_PROFILER_SCOPE(_name) demo::ProfilerScope BASE_CONCATENATE(profilerScope, __LINE__)(_name)
+#else
+#	define DEMO_PROFILER_SCOPE(_name) BASE_NOOP()
+#endif // DEMO_CONFIG_PROFILER
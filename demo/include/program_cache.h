@@ -0,0 +1,49 @@
+#pragma once
+
+#include "pakx_reader.h"
+
+// std
+#include <thread>
+#include <vector>
+
+namespace demo
+{
+	// Creates every shader program listed in the .pakx program table once, before any material loads.
+	//
+	// Bytecode is read on a worker thread while the PAK loads, the programs are then created on the
+	// main thread. Materials loading afterwards only share these if the renderer hands out the same
+	// shader and program for identical bytecode, nothing here hands the programs to them.
+	class ProgramCache
+	{
+	public:
+		ProgramCache();
+		~ProgramCache();
+
+		// Starts reading the program table in the background.
+		bool init(PakxReader* _reader);
+
+		// Waits for the background read and creates all programs.
+		void warm();
+
+		void shutdown();
+
+		U32 getNumPrograms() const { return (U32)m_programHandles.size(); }
+		F64 getWarmTimeMs() const { return m_warmTimeMs; }
+
+	private:
+		void readProgramTable();
+
+		PakxReader* m_reader;
+		std::thread m_thread;
+
+		std::vector<pakx::ProgramShader> m_shaders;
+		std::vector<pakx::Program> m_programs;
+		std::vector<std::vector<U8> > m_bytecode;
+
+		std::vector<graphics::ShaderHandle> m_shaderHandles;
+		std::vector<graphics::ProgramHandle> m_programHandles;
+		I64 m_initTime;
+		F64 m_warmTimeMs;
+	};
+
+} // namespace demo
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "pakx_reader.h"
+
+// std
+#include <unordered_map>
+#include <vector>
+
+namespace demo
+{
+	// Memory accounting of loaded engine resources. The engine only reports path and reference count, sizes
+	// and types come from the resources table in the .pakx. Resources are polled once per frame, which gives
+	// the time each was first seen loaded and the last frame it was referenced.
+	class ResourceStats
+	{
+	public:
+		struct Entry
+		{
+			base::FilePath vfp;
+			U32 vfpHash;
+			pakx::ResourceType::Enum type; // Count if the resource isn't in the .pakx
+			U16 refCount;
+			bool isLoaded;
+			U32 cpuBytes;
+			U32 gpuBytes;
+			F64 firstSeenMs; // Time since init the resource was first seen loaded, not how long loading took
+			U32 lastUsedFrame;
+		};
+
+		struct Totals
+		{
+			U32 numResources;
+			U64 cpuBytes;
+			U64 gpuBytes;
+			U64 budgetBytes; // CPU and GPU bytes combined, 0 if unlimited
+		};
+
+		ResourceStats();
+
+		// Works without a .pakx, sizes are then unknown.
+		void init(PakxReader* _reader);
+		void shutdown();
+
+		void setBudget(pakx::ResourceType::Enum _type, U64 _bytes);
+
+		void update();
+
+		// Entries sorted by CPU and GPU bytes combined, largest first.
+		U32 getNumEntries() const { return (U32)m_order.size(); }
+		const Entry& getEntry(U32 _index) const { return m_entries[m_order[_index]]; }
+
+		// Totals of loaded resources, indexed by type. Count holds resources of unknown type.
+		const Totals& getTotals(pakx::ResourceType::Enum _type) const { return m_totals[_type]; }
+
+		U32 getFrame() const { return m_frame; }
+
+		bool exportCsv(const base::FilePath& _filePath) const;
+
+		static const char* getTypeName(pakx::ResourceType::Enum _type);
+
+	private:
+		std::unordered_map<U32, pakx::Resource> m_sizes;
+		std::unordered_map<U32, U32> m_entryLookup;
+		std::vector<Entry> m_entries;
+		std::vector<U32> m_order;
+		std::vector<mara::ResourceInfo> m_infos; // Grown to the engine's resource count before every query
+		Totals m_totals[pakx::ResourceType::Count + 1];
+		I64 m_initTime;
+		U32 m_frame;
+	};
+
+} // namespace demo
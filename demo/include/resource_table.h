@@ -0,0 +1,100 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+// std
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace demo
+{
+	// Slot index in the low 16 bits, generation in the high 16 bits.
+	struct ResourceRef
+	{
+		U32 value;
+	};
+
+	constexpr ResourceRef kInvalidResourceRef = { UINT32_MAX };
+
+	inline bool isValid(ResourceRef _ref)
+	{
+		return _ref.value != UINT32_MAX;
+	}
+
+	// Shared resources keyed by their virtual path hash, handed out as generational handles.
+	//
+	// Handles go stale when their slot is reused, so a handle held past the resource's lifetime reads
+	// NULL instead of another resource. Reference counts and get are lock-free, find and insert take a
+	// lock, all are safe from any thread. Resources whose count drops to zero are destroyed by collect
+	// at the end of the frame, work recorded for the current frame can still use them until then.
+	class ResourceTable
+	{
+	public:
+		typedef void (*DestroyFn)(void* _data);
+
+		ResourceTable();
+		~ResourceTable();
+
+		bool init(U32 _maxResources, DestroyFn _destroy);
+		void shutdown();
+
+		// Returns the resource registered under _vfpHash with a reference added, invalid if there is none.
+		ResourceRef find(U32 _vfpHash);
+
+		// Registers _data with one reference. If another thread registered the same path first, their
+		// resource is returned instead and the caller still owns _data, check with get.
+		ResourceRef insert(U32 _vfpHash, void* _data);
+
+		// Swaps the resource behind a handle, every handle to it sees _data from then on. The previous data
+		// is destroyed by collect. Fails if the handle is stale.
+		bool replace(ResourceRef _ref, void* _data);
+
+		// Adds a reference, fails if the handle is stale.
+		bool acquire(ResourceRef _ref);
+		void release(ResourceRef _ref);
+
+		// Returns NULL if the handle is stale or invalid.
+		void* get(ResourceRef _ref) const
+		{
+			if (!isValid(_ref) || NULL == m_slots || (_ref.value & 0xffff) >= m_maxResources)
+			{
+				return NULL;
+			}
+
+			const Slot& slot = m_slots[_ref.value & 0xffff];
+			return (slot.state.load(std::memory_order_acquire) >> 32) == (_ref.value >> 16) ? slot.data.load(std::memory_order_acquire) : NULL;
+		}
+
+		// Destroys resources that are still unreferenced and data replaced since the last call. Main thread,
+		// once per frame after rendering.
+		void collect();
+
+		U32 getNumResources() const { return m_numResources; }
+		U32 getNumPending() const;
+
+	private:
+		struct Slot
+		{
+			Slot();
+
+			std::atomic<U64> state; // Generation in the high 32 bits, reference count in the low ones
+			std::atomic<void*> data;
+			U32 vfpHash;
+		};
+
+		Slot* m_slots;
+		U32 m_maxResources;
+		DestroyFn m_destroy;
+
+		mutable std::mutex m_mutex; // Guards everything below
+		std::unordered_map<U32, U16> m_lookup;
+		std::vector<U16> m_free;
+		std::vector<U16> m_pending;
+		std::vector<void*> m_replaced;
+		U32 m_numResources;
+	};
+
+} // namespace demo
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "pakx_reader.h"
+
+// std
+#include <vector>
+
+namespace demo
+{
+	// Texture arrays from the .pakx, created once at load. Meshes bind their array and pick their layer
+	// through the material block, so meshes of different materials share one texture binding.
+	class TextureArrays
+	{
+	public:
+		TextureArrays();
+		~TextureArrays();
+
+		bool init(PakxReader* _reader);
+		void shutdown();
+
+		void bind(U8 _stage, graphics::UniformHandle _sampler, U32 _array) const;
+
+		U32 getNumArrays() const { return (U32)m_handles.size(); }
+		U64 getMemoryBytes() const { return m_memoryBytes; }
+
+	private:
+		std::vector<graphics::TextureHandle> m_handles;
+		U64 m_memoryBytes;
+	};
+
+} // namespace demo
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "pakx_reader.h"
+
+// std
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+namespace demo
+{
+	// Streams textures from the .pakx mip by mip.
+	//
+	// The mip tail of every texture is loaded at init, so everything can be drawn from the first frame.
+	// Higher mips are requested by the renderer from the projected size on screen, read on a worker
+	// thread and uploaded on the main thread. Resident memory is kept within a budget by dropping the
+	// least recently used textures back to their tail.
+	class TextureStreamer
+	{
+	public:
+		struct Stats
+		{
+			U32 numTextures;
+			U32 numPendingReads;
+			U32 numUploads;
+			U32 numEvictions;
+			U64 residentBytes;
+			U64 budgetBytes;
+		};
+
+		TextureStreamer();
+		~TextureStreamer();
+
+		bool init(PakxReader* _reader, U64 _budgetBytes);
+		void shutdown();
+
+		void setBudget(U64 _budgetBytes) { m_stats.budgetBytes = _budgetBytes; }
+
+		// Register use of a texture this frame. _screenSize is the projected size in pixels of what
+		// the texture is mapped onto.
+		void request(U32 _texture, F32 _screenSize);
+
+		// Binds the currently resident version of the texture.
+		void bind(U8 _stage, graphics::UniformHandle _sampler, U32 _texture) const;
+
+		// Call once per frame after rendering. Uploads finished reads and issues new ones.
+		void update();
+
+		const Stats& getStats() const { return m_stats; }
+
+	private:
+		struct Texture
+		{
+			pakx::StreamTexture info;
+			graphics::TextureHandle handle;
+			U8 residentMip;
+			U8 wantedMip;
+			U8 pendingMip;
+			U32 lastUsedFrame;
+			std::vector<U8> tail;
+		};
+
+		struct Read
+		{
+			U32 texture;
+			U8 mip;
+			std::vector<U8> data; // Mips [mip, tailMip) back to back
+		};
+
+		U64 getMipChainSize(const Texture& _texture, U8 _mip) const;
+		void recreate(Texture& _texture, U8 _mip, const U8* _data);
+		bool makeRoom(U64 _bytes);
+		void issueReads();
+		void applyReads();
+		void worker();
+
+		PakxReader* m_reader;
+		std::vector<Texture> m_textures;
+		U32 m_frame;
+		U64 m_pendingBytes;
+		Stats m_stats;
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::deque<Read> m_requests;
+		std::deque<Read> m_finished;
+		bool m_quit;
+	};
+
+} // namespace demo
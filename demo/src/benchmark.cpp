@@ -0,0 +1,285 @@
+#include "benchmark.h"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace demo
+{
+	namespace
+	{
+		std::atomic<U64> s_numAllocations(0);
+
+		constexpr const char* kSystemNames[] =
+		{
+			"camera",
+			"input",
+			"movement",
+			"render",
+		};
+		static_assert(BASE_COUNTOF(kSystemNames) == BenchmarkSystem::Count, "Missing system name");
+
+		constexpr I32 kAxisMax = 32767;
+
+		F64 toNs(F64 _ticks)
+		{
+			return _ticks * 1e9 / F64(base::getHPFrequency());
+		}
+
+		F64 mean(const std::vector<F64>& _values)
+		{
+			F64 sum = 0.0;
+			for (F64 value : _values)
+			{
+				sum += value;
+			}
+
+			return _values.empty() ? 0.0 : sum / F64(_values.size());
+		}
+
+		void writeText(base::FileWriter& _writer, const char* _text, base::Error* _err)
+		{
+			U32 len = 0;
+			while (_text[len] != '\0') len++;
+			base::write(&_writer, _text, (I32)len, _err);
+		}
+
+	} // namespace
+
+	void benchmarkGetInput(BenchmarkInput& _input, U32 _frame)
+	{
+		// Periods don't divide each other so the pattern takes long to repeat
+		const F32 time = F32(_frame) / 60.0f;
+		_input.leftX = I32(base::sin(time * 0.7f) * kAxisMax);
+		_input.leftY = I32(base::cos(time * 0.3f) * kAxisMax);
+		_input.rightX = I32(base::sin(time * 1.3f) * kAxisMax);
+		_input.rightY = I32(base::sin(time * 0.5f) * 0.25f * kAxisMax);
+		_input.shoulderLeft = (_frame / 97) % 4 == 1;
+		_input.shoulderRight = (_frame / 61) % 3 == 2;
+	}
+
+	U64 benchmarkGetNumAllocations()
+	{
+		return s_numAllocations.load(std::memory_order_relaxed);
+	}
+
+	const char* benchmarkGetArg(I32 _argc, const char* const* _argv, const char* _name)
+	{
+		for (I32 i = 1; i + 1 < _argc; i++)
+		{
+			if (0 == std::strcmp(_argv[i], _name))
+			{
+				return _argv[i + 1];
+			}
+		}
+
+		return NULL;
+	}
+
+	bool benchmarkHasArg(I32 _argc, const char* const* _argv, const char* _name)
+	{
+		for (I32 i = 1; i < _argc; i++)
+		{
+			if (0 == std::strcmp(_argv[i], _name))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	F64 benchmarkPercentile(std::vector<F64>& _values, F64 _percent)
+	{
+		if (_values.empty())
+		{
+			return 0.0;
+		}
+
+		std::sort(_values.begin(), _values.end());
+		const U32 rank = (U32)base::ceil(F32(_percent / 100.0 * F64(_values.size())));
+		return _values[base::clamp<U32>(rank, 1, (U32)_values.size()) - 1];
+	}
+
+	SystemBenchmark::SystemBenchmark()
+		: m_frameStart(0)
+		, m_frameStartAllocations(0)
+		, m_numEntities(0)
+		, m_numWarmupFrames(0)
+		, m_numFrames(0)
+		, m_frame(0)
+	{
+		base::memSet(&m_current, 0, sizeof(m_current));
+		base::memSet(m_systemStart, 0, sizeof(m_systemStart));
+		base::memSet(m_systemStartAllocations, 0, sizeof(m_systemStartAllocations));
+	}
+
+	void SystemBenchmark::init(U32 _numEntities, U32 _numWarmupFrames, U32 _numFrames)
+	{
+		m_numEntities = _numEntities;
+		m_numWarmupFrames = _numWarmupFrames;
+		m_numFrames = _numFrames;
+		m_frame = 0;
+
+		// Recording must not allocate
+		m_frames.clear();
+		m_frames.reserve(_numFrames);
+	}
+
+	void SystemBenchmark::beginFrame()
+	{
+		base::memSet(&m_current, 0, sizeof(m_current));
+		m_frameStartAllocations = benchmarkGetNumAllocations();
+		m_frameStart = base::getHPCounter();
+	}
+
+	void SystemBenchmark::endFrame()
+	{
+		m_current.totalTicks = base::getHPCounter() - m_frameStart;
+		m_current.numAllocations = benchmarkGetNumAllocations() - m_frameStartAllocations;
+		if (isRecording())
+		{
+			m_frames.push_back(m_current);
+		}
+
+		m_frame++;
+	}
+
+	void SystemBenchmark::beginSystem(BenchmarkSystem::Enum _system)
+	{
+		m_systemStartAllocations[_system] = benchmarkGetNumAllocations();
+		m_systemStart[_system] = base::getHPCounter();
+	}
+
+	void SystemBenchmark::endSystem(BenchmarkSystem::Enum _system)
+	{
+		m_current.systemTicks[_system] += base::getHPCounter() - m_systemStart[_system];
+		m_current.systemAllocations[_system] += benchmarkGetNumAllocations() - m_systemStartAllocations[_system];
+	}
+
+	bool SystemBenchmark::writeJson(const base::FilePath& _filePath) const
+	{
+		base::FileWriter writer;
+		base::Error err;
+		if (!base::open(&writer, _filePath, false, &err))
+		{
+			BASE_TRACE("Failed: Opening %s for writing", _filePath.getCPtr())
+			return false;
+		}
+
+		std::vector<F64> values;
+		values.reserve(m_frames.size());
+
+		// Whole frames, including the engine update and graphics::frame
+		for (const Frame& frame : m_frames)
+		{
+			values.push_back(toNs(F64(frame.totalTicks)) / 1e6);
+		}
+		const F64 frameMean = mean(values);
+		const F64 frameP50 = benchmarkPercentile(values, 50.0);
+		const F64 frameP99 = benchmarkPercentile(values, 99.0);
+
+		values.clear();
+		for (const Frame& frame : m_frames)
+		{
+			values.push_back(F64(frame.numAllocations));
+		}
+		const F64 allocationsMean = mean(values);
+		const F64 allocationsMax = values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+
+		char line[512];
+		I32 len = base::snprintf(line, sizeof(line), "{\n\t\"entities\": %u,\n\t\"frames\": %u,\n\t\"warmupFrames\": %u,\n"
+			"\t\"frameMs\": { \"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f },\n"
+			"\t\"allocationsPerFrame\": { \"mean\": %.2f, \"max\": %.0f },\n\t\"systems\": [",
+			m_numEntities, (U32)m_frames.size(), m_numWarmupFrames, frameMean, frameP50, frameP99, allocationsMean, allocationsMax);
+		base::write(&writer, line, len, &err);
+
+		for (U32 i = 0; i < BenchmarkSystem::Count; i++)
+		{
+			values.clear();
+			F64 allocations = 0.0;
+			for (const Frame& frame : m_frames)
+			{
+				values.push_back(toNs(F64(frame.systemTicks[i])));
+				allocations += F64(frame.systemAllocations[i]);
+			}
+			allocations = m_frames.empty() ? 0.0 : allocations / F64(m_frames.size());
+
+			const F64 nsMean = mean(values);
+			len = base::snprintf(line, sizeof(line), "%s\n\t\t{ \"name\": \"%s\", \"nsPerEntity\": %.2f, \"meanUs\": %.3f, "
+				"\"p50Us\": %.3f, \"p99Us\": %.3f, \"allocationsPerFrame\": %.2f }",
+				i > 0 ? "," : "", kSystemNames[i], nsMean / F64(base::max<U32>(m_numEntities, 1)), nsMean / 1e3,
+				benchmarkPercentile(values, 50.0) / 1e3, benchmarkPercentile(values, 99.0) / 1e3, allocations);
+			base::write(&writer, line, len, &err);
+		}
+
+		writeText(writer, "\n\t]\n}\n", &err);
+		base::close(&writer);
+
+		return true;
+	}
+
+	void SystemBenchmark::printSummary() const
+	{
+		BASE_TRACE("Benchmark: %d entities, %d frames after %d warmup frames", m_numEntities, (U32)m_frames.size(),
+			m_numWarmupFrames)
+
+		for (U32 i = 0; i < BenchmarkSystem::Count; i++)
+		{
+			F64 ticks = 0.0;
+			F64 allocations = 0.0;
+			for (const Frame& frame : m_frames)
+			{
+				ticks += F64(frame.systemTicks[i]);
+				allocations += F64(frame.systemAllocations[i]);
+			}
+
+			const F64 numFrames = F64(base::max<U32>((U32)m_frames.size(), 1));
+			BASE_TRACE("  %-10s %10.2f ns/entity %8.1f allocations/frame", kSystemNames[i],
+				toNs(ticks / numFrames) / F64(base::max<U32>(m_numEntities, 1)), allocations / numFrames)
+		}
+	}
+
+} // namespace demo
+
+#if DEMO_CONFIG_BENCHMARK
+// Counts every heap allocation of the benchmark build, the window build keeps the default allocator
+void* operator new(size_t _size)
+{
+	demo::s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+	void* ptr = std::malloc(0 != _size ? _size : 1);
+	if (NULL == ptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](size_t _size)
+{
+	return operator new(_size);
+}
+
+void operator delete(void* _ptr) noexcept
+{
+	std::free(_ptr);
+}
+
+void operator delete[](void* _ptr) noexcept
+{
+	std::free(_ptr);
+}
+
+void operator delete(void* _ptr, size_t) noexcept
+{
+	std::free(_ptr);
+}
+
+void operator delete[](void* _ptr, size_t) noexcept
+{
+	std::free(_ptr);
+}
+#endif // DEMO_CONFIG_BENCHMARK
@@ -0,0 +1,114 @@
+#include "file_watcher.h"
+
+// std
+#include <algorithm>
+
+#if BASE_PLATFORM_LINUX
+#	include <sys/inotify.h>
+#	include <unistd.h>
+#endif // BASE_PLATFORM_LINUX
+
+namespace demo
+{
+	FileWatcher::FileWatcher()
+		: m_fd(-1)
+	{}
+
+	FileWatcher::~FileWatcher()
+	{
+		shutdown();
+	}
+
+	bool FileWatcher::init(const char* _dir)
+	{
+		shutdown();
+
+#if BASE_PLATFORM_LINUX
+		m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_fd < 0)
+		{
+			return false;
+		}
+
+		// Writers either rewrite the file or move a finished one over it
+		if (inotify_add_watch(m_fd, _dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+		{
+			BASE_TRACE("Failed: Watching %s for changes", _dir)
+			shutdown();
+			return false;
+		}
+
+		return true;
+#else
+		BASE_TRACE("Failed: Watching %s for changes, not supported on this platform", _dir)
+		return false;
+#endif // BASE_PLATFORM_LINUX
+	}
+
+	void FileWatcher::shutdown()
+	{
+#if BASE_PLATFORM_LINUX
+		if (m_fd >= 0)
+		{
+			::close(m_fd);
+		}
+#endif // BASE_PLATFORM_LINUX
+
+		m_fd = -1;
+		m_changed.clear();
+	}
+
+	bool FileWatcher::hasChanged(const char* _name)
+	{
+		readEvents();
+
+		auto it = std::find(m_changed.begin(), m_changed.end(), _name);
+		if (it == m_changed.end())
+		{
+			return false;
+		}
+
+		m_changed.erase(it);
+		return true;
+	}
+
+	void FileWatcher::readEvents()
+	{
+#if BASE_PLATFORM_LINUX
+		if (m_fd < 0)
+		{
+			return;
+		}
+
+		alignas(inotify_event) char buffer[4096];
+		for (;;)
+		{
+			const ssize_t size = ::read(m_fd, buffer, sizeof(buffer));
+			if (size <= 0)
+			{
+				break;
+			}
+
+			// Events are variable sized, the name follows each one
+			for (ssize_t offset = 0; offset < size;)
+			{
+				const inotify_event* event = (const inotify_event*)&buffer[offset];
+				offset += sizeof(inotify_event) + event->len;
+
+				if (event->len == 0)
+				{
+					continue;
+				}
+
+				// Several writes before the next call count once
+				const std::string name(event->name);
+				if (std::find(m_changed.begin(), m_changed.end(), name) == m_changed.end())
+				{
+					m_changed.push_back(name);
+				}
+			}
+		}
+#endif // BASE_PLATFORM_LINUX
+	}
+
+} // namespace demo
@@ -0,0 +1,305 @@
+#include "load_benchmark.h"
+
+#if BASE_PLATFORM_LINUX
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif // BASE_PLATFORM_LINUX
+
+namespace demo
+{
+	namespace
+	{
+		constexpr const char* kStageNames[] =
+		{
+			"open",
+			"load",
+			"create",
+			"run",
+		};
+		static_assert(BASE_COUNTOF(kStageNames) == PakLoadStage::Count, "Missing stage name");
+
+		constexpr const char* kMaterialPath = "benchmark/material.bin";
+		constexpr const char* kVertexShaderPath = "benchmark/vs_cube.bin";
+		constexpr const char* kFragmentShaderPath = "benchmark/fs_cube.bin";
+		constexpr U32 kMaxGeometryVertices = UINT16_MAX;
+
+		struct BenchmarkVertex
+		{
+			F32 x, y, z;
+			F32 u, v;
+			F32 nx, ny, nz;
+		};
+
+		F64 toMs(I64 _ticks)
+		{
+			return F64(_ticks) * 1000.0 / F64(base::getHPFrequency());
+		}
+
+		void getPrefabPath(char* _out, U32 _max, U32 _index)
+		{
+			base::snprintf(_out, _max, "benchmark/prefab_%u.bin", _index);
+		}
+
+		// Creates a shader resource at _vfp from the bytecode of _sourceVfp in the .pakx program table.
+		bool copyShader(PakxReader& _reader, const char* _sourceVfp, const char* _vfp)
+		{
+			pakx::ProgramsHeader header;
+			if (!_reader.read(pakx::kChunkPrograms, 0, &header, sizeof(header)))
+			{
+				return false;
+			}
+
+			std::vector<pakx::ProgramShader> shaders(header.numShaders);
+			_reader.read(pakx::kChunkPrograms, sizeof(header), shaders.data(), (U32)(shaders.size() * sizeof(pakx::ProgramShader)));
+
+			const U32 vfpHash = pakx::hashVfp(_sourceVfp);
+			for (const pakx::ProgramShader& shader : shaders)
+			{
+				std::vector<U8> bytecode(shader.size);
+				if (shader.vfpHash != vfpHash || !_reader.read(pakx::kChunkPrograms, shader.offset, bytecode.data(), shader.size))
+				{
+					continue;
+				}
+
+				mara::ShaderCreate data;
+				data.mem = graphics::copy(bytecode.data(), (U32)bytecode.size());
+				mara::createResource(data, _vfp);
+				return true;
+			}
+
+			BASE_TRACE("Failed: %s is not in the program table", _sourceVfp)
+			return false;
+		}
+
+		F64 mean(const std::vector<F64>& _values)
+		{
+			F64 sum = 0.0;
+			for (F64 value : _values)
+			{
+				sum += value;
+			}
+
+			return _values.empty() ? 0.0 : sum / F64(_values.size());
+		}
+
+	} // namespace
+
+	U32 getNumBenchmarkPrefabs(U32 _numEntries)
+	{
+		// Geometry, mesh and prefab per prefab, plus the shared material
+		return base::max<U32>((base::max<U32>(_numEntries, 1) - 1) / 3, 1);
+	}
+
+	bool generateBenchmarkPak(const base::FilePath& _filePath, U32 _numEntries, U64 _totalBytes, PakxReader& _shaders)
+	{
+		const U32 numPrefabs = getNumBenchmarkPrefabs(_numEntries);
+
+		// Untextured variants, the same the compiler uses for materials without textures
+		if (!copyShader(_shaders, "shaders/vs_cube.bin", kVertexShaderPath)
+			|| !copyShader(_shaders, "shaders/fs_cube.bin", kFragmentShaderPath))
+		{
+			return false;
+		}
+
+		mara::MaterialCreate material;
+		material.vertShaderPath = kVertexShaderPath;
+		material.fragShaderPath = kFragmentShaderPath;
+		mara::createResource(material, kMaterialPath);
+
+		graphics::VertexLayout layout;
+		layout.begin()
+			.add(graphics::Attrib::Position, 3, graphics::AttribType::Float)
+			.add(graphics::Attrib::TexCoord0, 2, graphics::AttribType::Float)
+			.add(graphics::Attrib::Normal, 3, graphics::AttribType::Float)
+			.end();
+
+		// Three indices per vertex, geometry can't go past 16 bit indices
+		const U64 bytesPerPrefab = _totalBytes / numPrefabs;
+		const U32 numVertices = (U32)base::clamp<U64>(bytesPerPrefab / (sizeof(BenchmarkVertex) + 3 * sizeof(U16)), 3,
+			kMaxGeometryVertices);
+		if (bytesPerPrefab > U64(kMaxGeometryVertices) * (sizeof(BenchmarkVertex) + 3 * sizeof(U16)))
+		{
+			BASE_TRACE("Benchmark PAK: %d entries can't hold %llu bytes, raise the entry count", _numEntries,
+				(unsigned long long)_totalBytes)
+		}
+
+		std::vector<BenchmarkVertex> vertices(numVertices);
+		std::vector<U16> indices(numVertices * 3);
+
+		// Xorshift, the same PAK on every run without repeating data between entries
+		U32 state = 0x9e3779b9u;
+		for (U32 i = 0; i < numPrefabs; i++)
+		{
+			for (BenchmarkVertex& vertex : vertices)
+			{
+				F32* values = &vertex.x;
+				for (U32 j = 0; j < 8; j++)
+				{
+					state ^= state << 13;
+					state ^= state >> 17;
+					state ^= state << 5;
+					values[j] = F32(state & 0xffff) / 65535.0f;
+				}
+			}
+			for (U32 j = 0; j < indices.size(); j++)
+			{
+				indices[j] = U16((j / 3 + j % 3) % numVertices);
+			}
+
+			char geometryPath[128];
+			base::snprintf(geometryPath, sizeof(geometryPath), "benchmark/geometry_%u.bin", i);
+			mara::GeometryCreate geometry;
+			geometry.vertices = vertices.data();
+			geometry.verticesSize = (U32)(vertices.size() * sizeof(BenchmarkVertex));
+			geometry.indices = indices.data();
+			geometry.indicesSize = (U32)(indices.size() * sizeof(U16));
+			geometry.layout = layout;
+			mara::createResource(geometry, geometryPath);
+
+			char meshPath[128];
+			base::snprintf(meshPath, sizeof(meshPath), "benchmark/mesh_%u.bin", i);
+			mara::MeshCreate mesh;
+			mesh.geometryPath = geometryPath;
+			mesh.materialPath = kMaterialPath;
+			base::mtxIdentity(mesh.m_transform);
+			mara::createResource(mesh, meshPath);
+
+			char prefabPath[128];
+			getPrefabPath(prefabPath, sizeof(prefabPath), i);
+			mara::PrefabCreate prefab;
+			prefab.m_numMeshes = 1;
+			prefab.meshPaths[0] = meshPath;
+			mara::createResource(prefab, prefabPath);
+		}
+
+		mara::createPak(_filePath);
+		BASE_TRACE("Benchmark PAK: %d prefabs, %llu geometry bytes written to %s", numPrefabs,
+			(unsigned long long)(U64(numPrefabs) * numVertices * (sizeof(BenchmarkVertex) + 3 * sizeof(U16))), _filePath.getCPtr())
+
+		return true;
+	}
+
+	bool dropFileCache(const char* _path)
+	{
+#if BASE_PLATFORM_LINUX
+		const int fd = ::open(_path, O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		// Dirty pages stay cached, the PAK may have just been written
+		fdatasync(fd);
+		const bool isDropped = 0 == posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		::close(fd);
+		return isDropped;
+#else
+		BASE_UNUSED(_path);
+		return false;
+#endif // BASE_PLATFORM_LINUX
+	}
+
+	PakLoadBenchmark::PakLoadBenchmark()
+		: m_numEntries(0)
+		, m_numRuns(0)
+		, m_isCold(false)
+	{}
+
+	void PakLoadBenchmark::run(const base::FilePath& _filePath, U32 _numEntries, U32 _numRuns, bool _isCold)
+	{
+		const U32 numPrefabs = getNumBenchmarkPrefabs(_numEntries);
+		m_numEntries = _numEntries;
+		m_numRuns = _numRuns;
+		m_isCold = _isCold;
+
+		// Mode is settled up front so the report never mixes cold and warm runs
+		if (_isCold && !dropFileCache(_filePath.getCPtr()))
+		{
+			BASE_TRACE("Benchmark: Can't drop %s from the page cache, measuring warm", _filePath.getCPtr())
+			m_isCold = false;
+		}
+
+		std::vector<mara::PrefabHandle> prefabs(numPrefabs);
+		for (U32 run = 0; run < _numRuns; run++)
+		{
+			if (m_isCold && run > 0)
+			{
+				dropFileCache(_filePath.getCPtr());
+			}
+
+			const I64 runStart = base::getHPCounter();
+			mara::loadPak(_filePath);
+			m_samplesMs[PakLoadStage::Open].push_back(toMs(base::getHPCounter() - runStart));
+
+			for (U32 i = 0; i < numPrefabs; i++)
+			{
+				char prefabPath[128];
+				getPrefabPath(prefabPath, sizeof(prefabPath), i);
+
+				const I64 loadStart = base::getHPCounter();
+				const mara::ResourceHandle resource = mara::loadPrefab(prefabPath);
+				const I64 createStart = base::getHPCounter();
+				prefabs[i] = mara::createPrefab(resource);
+				const I64 createEnd = base::getHPCounter();
+
+				m_samplesMs[PakLoadStage::Load].push_back(toMs(createStart - loadStart));
+				m_samplesMs[PakLoadStage::Create].push_back(toMs(createEnd - createStart));
+			}
+			m_samplesMs[PakLoadStage::Run].push_back(toMs(base::getHPCounter() - runStart));
+
+			// Next run starts from nothing loaded
+			for (mara::PrefabHandle prefab : prefabs)
+			{
+				mara::destroy(prefab);
+			}
+			mara::unloadPak(_filePath);
+		}
+	}
+
+	bool PakLoadBenchmark::writeJson(const base::FilePath& _filePath) const
+	{
+		base::FileWriter writer;
+		base::Error err;
+		if (!base::open(&writer, _filePath, false, &err))
+		{
+			BASE_TRACE("Failed: Opening %s for writing", _filePath.getCPtr())
+			return false;
+		}
+
+		char line[512];
+		I32 len = base::snprintf(line, sizeof(line), "{\n\t\"entries\": %u,\n\t\"prefabs\": %u,\n\t\"runs\": %u,\n\t\"cold\": %s,\n"
+			"\t\"stages\": [", m_numEntries, getNumBenchmarkPrefabs(m_numEntries), m_numRuns, m_isCold ? "true" : "false");
+		base::write(&writer, line, len, &err);
+
+		for (U32 i = 0; i < PakLoadStage::Count; i++)
+		{
+			std::vector<F64> samples = m_samplesMs[i];
+			const F64 meanMs = mean(samples);
+			len = base::snprintf(line, sizeof(line), "%s\n\t\t{ \"name\": \"%s\", \"samples\": %u, \"meanMs\": %.4f, \"p50Ms\": %.4f, "
+				"\"p90Ms\": %.4f, \"p99Ms\": %.4f, \"maxMs\": %.4f }", i > 0 ? "," : "", kStageNames[i], (U32)samples.size(), meanMs,
+				benchmarkPercentile(samples, 50.0), benchmarkPercentile(samples, 90.0), benchmarkPercentile(samples, 99.0),
+				benchmarkPercentile(samples, 100.0));
+			base::write(&writer, line, len, &err);
+		}
+
+		len = base::snprintf(line, sizeof(line), "\n\t]\n}\n");
+		base::write(&writer, line, len, &err);
+		base::close(&writer);
+
+		return true;
+	}
+
+	void PakLoadBenchmark::printSummary() const
+	{
+		BASE_TRACE("Benchmark: %d prefabs loaded %d times, %s cache", getNumBenchmarkPrefabs(m_numEntries), m_numRuns,
+			m_isCold ? "cold" : "warm")
+
+		for (U32 i = 0; i < PakLoadStage::Count; i++)
+		{
+			std::vector<F64> samples = m_samplesMs[i];
+			BASE_TRACE("  %-8s p50 %8.3f ms, p90 %8.3f ms, p99 %8.3f ms", kStageNames[i], benchmarkPercentile(samples, 50.0),
+				benchmarkPercentile(samples, 90.0), benchmarkPercentile(samples, 99.0))
+		}
+	}
+
+} // namespace demo
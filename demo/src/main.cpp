@@ -8,22 +8,341 @@
 #include <imgui/imgui.h>
 #include <imgui/imgui_debug.h>
 
+#include "meshlet_culling.h"
+#include "benchmark.h"
+#include "file_watcher.h"
+#include "load_benchmark.h"
+#include "morph_targets.h"
+#include "node_hierarchy.h"
+#include "pakx_reader.h"
+#include "profiler.h"
+#include "program_cache.h"
+#include "resource_stats.h"
+#include "resource_table.h"
+#include "texture_arrays.h"
+#include "texture_streamer.h"
+
+// std
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace 
 {
+	// Directory holding assets.pak and its sidecar, --data on the command line or data/ next to the executable
+	std::string s_dataDir;
+
+	void initDataDir(I32 _argc, const char* const* _argv)
+	{
+		for (I32 i = 1; i + 1 < _argc; i++)
+		{
+			if (0 == std::strcmp(_argv[i], "--data"))
+			{
+				s_dataDir = _argv[i + 1];
+				if (!s_dataDir.empty() && s_dataDir.back() != '/' && s_dataDir.back() != '\\')
+				{
+					s_dataDir += '/';
+				}
+				return;
+			}
+		}
+
+		const std::string executable = _argc > 0 ? _argv[0] : "";
+		const size_t slash = executable.find_last_of("/\\");
+		s_dataDir = (slash != std::string::npos ? executable.substr(0, slash + 1) : std::string()) + "data/";
+	}
+
+	base::FilePath getDataPath(const char* _name)
+	{
+		return base::FilePath((s_dataDir + _name).c_str());
+	}
+
+	// Streaming
+	demo::PakxReader s_pakxFiles[2]; // A reload opens the rebuilt .pakx next to the one in use
+	demo::PakxReader* s_pakx = &s_pakxFiles[0];
+	demo::TextureStreamer s_textureStreamer;
+	demo::ProgramCache s_programCache;
+	demo::TextureArrays s_textureArrays;
+
+	// Blend shapes
+	demo::MorphTargets s_morphTargets;
+	graphics::UniformHandle s_morphSampler = GRAPHICS_INVALID_HANDLE;
+	graphics::UniformHandle s_morphUniform = GRAPHICS_INVALID_HANDLE;
+	bool s_animateMorphTargets = true;
+	F32 s_morphTime = 0.0f;
+
+	// Memory accounting
+	demo::ResourceStats s_resourceStats;
+
+	// Sizes come from the .pakx, so this runs again for every build that is loaded.
+	void initResourceStats(demo::PakxReader* _reader)
+	{
+		static const U64 kResourceBudgets[pakx::ResourceType::Count] =
+		{
+			64 << 20, // Geometry
+			128 << 20, // Texture, streamed textures have their own budget
+			1 << 20, // Material
+			8 << 20, // Shader
+			1 << 20, // Mesh
+			1 << 20, // Prefab
+		};
+		s_resourceStats.init(_reader);
+		for (U32 i = 0; i < pakx::ResourceType::Count; i++)
+		{
+			s_resourceStats.setBudget((pakx::ResourceType::Enum)i, kResourceBudgets[i]);
+		}
+	}
+
+	// Engine prefabs shared by every component showing the same prefab, released at the end of the frame.
+	// Sidecar data is copied so the resource outlives the .pakx it was loaded from.
+	struct PrefabResource
+	{
+		std::string vfp;
+		U32 version; // Changes with every load, also when memory of a replaced resource is reused
+		U32 contentHash; // From the .pakx prefab, same hash means the engine prefabs can stay
+		mara::PrefabHandle* parts; // Engine prefabs holding the meshes, in mesh order
+		U32 numParts;
+		std::vector<pakx::Mesh> records; // Per mesh data from .pakx, same order as prefab meshes
+		std::vector<U8> nodes; // Node block as laid out in the nodes chunk
+		U32 numNodes;
+	};
+
+	U32 s_prefabVersion = 0;
+
+	// Takes the engine prefabs over from _previous if given, otherwise loads them.
+	PrefabResource* createPrefabResource(const char* _vfp, PrefabResource* _previous)
+	{
+		const U32 vfpHash = pakx::hashVfp(_vfp);
+		const pakx::Prefab* prefab = s_pakx->findPrefab(vfpHash);
+
+		PrefabResource* resource = new PrefabResource;
+		resource->vfp = _vfp;
+		resource->version = ++s_prefabVersion;
+		resource->contentHash = NULL != prefab ? prefab->contentHash : 0;
+		resource->parts = NULL;
+		resource->numParts = 0;
+		resource->numNodes = 0;
+
+		U32 numRecords = 0;
+		const pakx::Mesh* records = s_pakx->findPrefabMeshes(vfpHash, &numRecords);
+		resource->records.assign(records, records + numRecords);
+
+		const U8* nodes = NULL != prefab ? (const U8*)s_pakx->getNodes(*prefab) : NULL;
+		if (NULL != nodes)
+		{
+			resource->nodes.assign(nodes, nodes + prefab->numNodes * (sizeof(U32) + 10 * sizeof(F32)));
+			resource->numNodes = prefab->numNodes;
+		}
+
+		if (NULL != _previous)
+		{
+			// Previous resource is destroyed without them
+			resource->parts = _previous->parts;
+			resource->numParts = _previous->numParts;
+			_previous->parts = NULL;
+			_previous->numParts = 0;
+			return resource;
+		}
+
+		// Meshes past what one engine prefab holds are in further parts
+		resource->numParts = NULL != prefab ? base::max<U32>(prefab->numParts, 1) : 1;
+		resource->parts = new mara::PrefabHandle[resource->numParts];
+		for (U32 i = 0; i < resource->numParts; i++)
+		{
+			char partPath[256];
+			pakx::getPartPath(partPath, sizeof(partPath), _vfp, i);
+			resource->parts[i] = mara::createPrefab(mara::loadPrefab(i == 0 ? _vfp : partPath));
+		}
+
+		return resource;
+	}
+
+	void destroyPrefabResource(void* _data)
+	{
+		PrefabResource* resource = (PrefabResource*)_data;
+		for (U32 i = 0; i < resource->numParts; i++)
+		{
+			mara::destroy(resource->parts[i]);
+		}
+
+		delete[] resource->parts;
+		delete resource;
+	}
+
+	constexpr U32 kMaxPrefabResources = 1024;
+	demo::ResourceTable s_prefabResources;
+
+	// Hot reload
+	demo::FileWatcher s_fileWatcher;
+	U32 s_numReloads = 0;
+
+	// Headless benchmark, only recorded in DEMO_CONFIG_BENCHMARK builds
+	demo::SystemBenchmark s_benchmark;
+
+#if DEMO_CONFIG_BENCHMARK
+	// PAK load benchmark, generating and loading run as separate invocations with the same entry count.
+	// Returns false if neither was asked for.
+	bool runLoadBenchmark(I32 _argc, const char* const* _argv)
+	{
+		constexpr U32 kEntries = 1000;
+		constexpr U32 kSizeMb = 64;
+		constexpr U32 kRuns = 10;
+
+		const char* generatePath = demo::benchmarkGetArg(_argc, _argv, "--generate-pak");
+		const char* loadPath = demo::benchmarkGetArg(_argc, _argv, "--load-pak");
+		if (NULL == generatePath && NULL == loadPath)
+		{
+			return false;
+		}
+
+		const char* entries = demo::benchmarkGetArg(_argc, _argv, "--entries");
+		const U32 numEntries = NULL != entries ? base::max(std::atoi(entries), 1) : kEntries;
+		if (NULL != generatePath)
+		{
+			// Shader bytecode comes from the demo's sidecar, the generated PAK holds its own copy
+			demo::PakxReader shaders;
+			const char* sizeMb = demo::benchmarkGetArg(_argc, _argv, "--size-mb");
+			const U64 totalBytes = U64(NULL != sizeMb ? base::max(std::atoi(sizeMb), 1) : kSizeMb) << 20;
+			if (shaders.open(getDataPath("assets.pakx")))
+			{
+				demo::generateBenchmarkPak(generatePath, numEntries, totalBytes, shaders);
+			}
+		}
+		else
+		{
+			const char* runs = demo::benchmarkGetArg(_argc, _argv, "--runs");
+			demo::PakLoadBenchmark loadBenchmark;
+			loadBenchmark.run(loadPath, numEntries, NULL != runs ? base::max(std::atoi(runs), 1) : kRuns,
+				!demo::benchmarkHasArg(_argc, _argv, "--warm"));
+			loadBenchmark.writeJson("benchmark_load.json");
+			loadBenchmark.printSummary();
+		}
+
+		return true;
+	}
+#endif // DEMO_CONFIG_BENCHMARK
+	graphics::UniformHandle s_diffuseSampler = GRAPHICS_INVALID_HANDLE;
+	graphics::TextureHandle s_defaultTexture = GRAPHICS_INVALID_HANDLE; // 1x1 white for samplers without data to bind
+
+	// Culling
+	struct CullingStats
+	{
+		U32 numMeshes;
+		U32 numCulledMeshes;
+		U32 numMeshlets;
+		U32 numVisibleMeshlets;
+	};
+
+	CullingStats s_cullingStats = {};
+	bool s_meshletConeCulling = true;
+
+	// Drawing
+	struct DrawItem
+	{
+		mara::MeshHandle mesh;
+		const pakx::Mesh* record;
+		const demo::MorphInstance* morph; // NULL if the mesh has no active blend shapes
+		bool isMorphed; // Drawn with the morph shader, also when its instance couldn't be created
+		U64 sortKey;
+		F32 mtx[16];
+	};
+
+	struct DrawStats
+	{
+		U32 numDraws;
+		U32 numInstances;
+		U32 numMaterialUploads;
+	};
+
+	std::vector<DrawItem> s_drawList;
+	DrawStats s_drawStats = {};
+	graphics::UniformHandle s_materialUniform = GRAPHICS_INVALID_HANDLE;
+	bool s_instancedDrawing = false; // Set when the .pakx was built with texture arrays
+
 	// Components
 	MARA_DEFINE_COMPONENT(COMPONENT_PREFAB)
 	struct PrefabComponent : mara::ComponentI
 	{
-		PrefabComponent()
-			: m_ph(MARA_INVALID_HANDLE)
-		{}
+		PrefabComponent(const char* _vfp)
+			: m_resource(demo::kInvalidResourceRef)
+			, m_version(0)
+			, m_meshRecords(NULL)
+			, m_numMeshRecords(0)
+			, m_lods(NULL)
+			, m_morphs(NULL)
+		{
+			DEMO_PROFILER_SCOPE("loadPrefab");
+
+			// Engine prefabs are loaded by the first component that shows them
+			m_resource = s_prefabResources.find(pakx::hashVfp(_vfp));
+			if (!demo::isValid(m_resource))
+			{
+				PrefabResource* resource = createPrefabResource(_vfp, NULL);
+				m_resource = s_prefabResources.insert(pakx::hashVfp(_vfp), resource);
+				if (s_prefabResources.get(m_resource) != resource)
+				{
+					destroyPrefabResource(resource);
+				}
+			}
+
+			const PrefabResource* resource = (const PrefabResource*)s_prefabResources.get(m_resource);
+			if (NULL != resource)
+			{
+				createInstance(*resource);
+			}
+		}
 
 		virtual ~PrefabComponent() override
 		{
-			mara::destroy(m_ph);
+			destroyInstance();
+			s_prefabResources.release(m_resource);
 		};
 
-		mara::PrefabHandle m_ph;
+		// Per copy state, built again when the resource is reloaded
+		void createInstance(const PrefabResource& _resource)
+		{
+			m_version = _resource.version;
+			m_meshRecords = _resource.records.data();
+			m_numMeshRecords = (U32)_resource.records.size();
+			m_nodes.init(_resource.nodes.data(), _resource.numNodes);
+
+			m_lods = new U8[m_numMeshRecords];
+			base::memSet(m_lods, 0, m_numMeshRecords);
+
+			// Every copy of a prefab poses its blend shapes on its own
+			m_morphs = new demo::MorphInstance[m_numMeshRecords];
+			for (U32 i = 0; i < m_numMeshRecords; i++)
+			{
+				s_morphTargets.createInstance(m_morphs[i], m_meshRecords[i]);
+			}
+		}
+
+		void destroyInstance()
+		{
+			for (U32 i = 0; i < m_numMeshRecords; i++)
+			{
+				s_morphTargets.destroyInstance(m_morphs[i]);
+			}
+
+			m_nodes.shutdown();
+			delete[] m_lods;
+			delete[] m_morphs;
+			m_lods = NULL;
+			m_morphs = NULL;
+			m_meshRecords = NULL;
+			m_numMeshRecords = 0;
+		}
+
+		demo::ResourceRef m_resource; // PrefabResource in s_prefabResources
+		U32 m_version; // Of the resource the state below was built from
+		demo::NodeHierarchy m_nodes; // Meshes are placed relative to their node
+		const pakx::Mesh* m_meshRecords; // Owned by the resource
+		U32 m_numMeshRecords;
+		U8* m_lods; // Selected LOD level, stored at the first level of every mesh
+		demo::MorphInstance* m_morphs; // Per mesh record, without a texture if the mesh has no targets
 	};
 
 	MARA_DEFINE_COMPONENT(COMPONENT_TRANSFORM)
@@ -147,9 +466,72 @@ namespace
 		F32* predya;
 	};
 
+	// Level of detail
+	constexpr F32 kLodErrorPixels = 1.0f; // Max simplification error on screen
+	constexpr F32 kLodHysteresis = 0.25f; // Switch to a coarser level only below (1 - kLodHysteresis) of the max error
+
+	F32 getPixelsPerUnit(const F32* _mtx, const pakx::Mesh& _record, const CameraComponent* _camera, F32 _projScale)
+	{
+		// Size in pixels of one mesh space unit at the distance of the mesh bounds
+		const F32 scale = base::max(base::length({ _mtx[0], _mtx[1], _mtx[2] }),
+			base::max(base::length({ _mtx[4], _mtx[5], _mtx[6] }), base::length({ _mtx[8], _mtx[9], _mtx[10] })));
+		const base::Vec3 center = base::mul({ _record.center[0], _record.center[1], _record.center[2] }, _mtx);
+		const F32 distance = base::max(base::length(base::sub(center, _camera->m_position)) - _record.radius * scale, _camera->m_near);
+
+		return scale * _projScale / distance;
+	}
+
+	U8 selectLod(const pakx::Mesh* _levels, U8 _current, F32 _pixelsPerUnit)
+	{
+		// Coarsest level whose projected error stays within the limit, errors grow with every level
+		const F32 radiusPixels = _levels[0].radius * _pixelsPerUnit;
+
+		U8 selected = 0;
+		for (U8 level = 1; level < _levels[0].numLods; level++)
+		{
+			const F32 errorPixels = _levels[level].lodError * radiusPixels;
+			const F32 maxErrorPixels = level > _current ? kLodErrorPixels * (1.0f - kLodHysteresis) : kLodErrorPixels;
+			if (errorPixels > maxErrorPixels)
+			{
+				break;
+			}
+			selected = level;
+		}
+
+		return selected;
+	}
+
+	U8 selectAuthoredLod(const pakx::Mesh* _levels, U8 _current, const F32* _mtx, const CameraComponent* _camera,
+		F32 _pixelsPerUnit, F32 _screenHeight)
+	{
+		// Last level whose threshold is met, thresholds come from the FBX LOD group in level order
+		const bool isScreenPercent = 0 != (_levels[0].lodFlags & pakx::kLodScreenPercent);
+		const base::Vec3 center = base::mul({ _levels[0].center[0], _levels[0].center[1], _levels[0].center[2] }, _mtx);
+		const F32 distance = base::length(base::sub(center, _camera->m_position));
+		const F32 screenPercent = 200.0f * _levels[0].radius * _pixelsPerUnit / _screenHeight;
+
+		U8 selected = 0;
+		for (U8 level = 1; level < _levels[0].numLods; level++)
+		{
+			const F32 threshold = _levels[level].lodThreshold;
+			const bool isMet = isScreenPercent
+				? screenPercent <= (level > _current ? threshold * (1.0f - kLodHysteresis) : threshold)
+				: distance >= (level > _current ? threshold * (1.0f + kLodHysteresis) : threshold);
+			if (!isMet)
+			{
+				break;
+			}
+			selected = level;
+		}
+
+		return selected;
+	}
+
 	// Systems
 	void render(F32 _dt)
 	{
+		DEMO_PROFILER_SCOPE("render");
+
 		// Clear screen
 		graphics::setViewClear(0, GRAPHICS_CLEAR_COLOR | GRAPHICS_CLEAR_DEPTH, 0x303030FF, 1.0f, 0);
 
@@ -158,6 +540,46 @@ namespace
 		// This system requires these components:
 		// - Prefab Component: Prefab that contains all meshes that should be rendered
 		// - Transform Component: Transform of entity (optional)
+
+		// Active camera is used to estimate how large meshes are on screen
+		const CameraComponent* activeCamera = NULL;
+		mara::EntityQuery* cameraQr = mara::queryEntities(COMPONENT_CAMERA);
+		for (U32 i = 0; i < cameraQr->m_count; i++)
+		{
+			const CameraComponent* cameraComponent = (CameraComponent*)mara::getComponentData(cameraQr->m_entities[i], COMPONENT_CAMERA);
+			if (cameraComponent->m_isActive)
+			{
+				activeCamera = cameraComponent;
+				break;
+			}
+		}
+		base::free(entry::getAllocator(), cameraQr);
+
+		const graphics::Stats* renderStats = graphics::getStats();
+		const F32 projScale = NULL != activeCamera
+			? F32(renderStats->height) / base::tan(base::toRad(activeCamera->m_fov) * 0.5f)
+			: 0.0f;
+
+		// Frustum of the active camera, meshes and meshlets outside of it are skipped
+		demo::Frustum frustum;
+		if (NULL != activeCamera)
+		{
+			F32 view[16];
+			base::mtxLookAt(view, activeCamera->m_position, activeCamera->m_lookAt);
+
+			F32 proj[16];
+			base::mtxProj(proj, activeCamera->m_fov, F32(renderStats->width) / F32(renderStats->height), activeCamera->m_near, activeCamera->m_far, graphics::getCaps()->homogeneousDepth);
+
+			F32 viewProj[16];
+			base::mtxMul(viewProj, view, proj);
+			demo::buildFrustum(frustum, viewProj, graphics::getCaps()->homogeneousDepth);
+		}
+		base::memSet(&s_cullingStats, 0, sizeof(s_cullingStats));
+		base::memSet(&s_drawStats, 0, sizeof(s_drawStats));
+		s_morphTargets.resetStats();
+		s_morphTime += _dt;
+		s_drawList.clear();
+
 		mara::EntityQuery* qr = mara::queryEntities(COMPONENT_PREFAB); 
 		{
 			// Forward render all loaded prefabs
@@ -167,19 +589,32 @@ namespace
 				PrefabComponent* prefab = (PrefabComponent*)mara::getComponentData(qr->m_entities[i], COMPONENT_PREFAB);
 				TransformComponent* transform = (TransformComponent*)mara::getComponentData(qr->m_entities[i], COMPONENT_TRANSFORM); 
 
-				// Go over all meshes in prefab
-				const mara::MeshHandle* meshes = mara::getMeshes(prefab->m_ph);
-				for (U16 i = 0; i < mara::getNumMeshes(prefab->m_ph); i++)
+				const PrefabResource* resource = (const PrefabResource*)s_prefabResources.get(prefab->m_resource);
+				if (NULL == resource)
 				{
-					const mara::MeshHandle mesh = meshes[i];
+					continue;
+				}
 
-					// Set render state for mesh
-					const U64 state = 0 | GRAPHICS_STATE_WRITE_RGB
-						| GRAPHICS_STATE_WRITE_A
-						| GRAPHICS_STATE_WRITE_Z
-						| GRAPHICS_STATE_DEPTH_TEST_LESS
-						| GRAPHICS_STATE_MSAA;
-					graphics::setState(state);
+				// Reloaded since the last frame
+				if (resource->version != prefab->m_version)
+				{
+					prefab->destroyInstance();
+					prefab->createInstance(*resource);
+				}
+
+				// Resolve node transforms moved since the last frame
+				prefab->m_nodes.update();
+
+				// Go over all meshes in prefab, every part but the last holds kMaxPartMeshes of them
+				U32 numMeshes = 0;
+				for (U32 part = 0; part < resource->numParts; part++)
+				{
+					numMeshes += mara::getNumMeshes(resource->parts[part]);
+				}
+				for (U32 i = 0; i < numMeshes; i++)
+				{
+					const mara::MeshHandle mesh = mara::getMeshes(resource->parts[i / pakx::kMaxPartMeshes])[i % pakx::kMaxPartMeshes];
+					const pakx::Mesh* record = i < prefab->m_numMeshRecords ? &prefab->m_meshRecords[i] : NULL;
 
 					// Create entity matrix
 					F32 entityMtx[16];
@@ -204,22 +639,196 @@ namespace
 						base::mtxMul(entityMtx, entityMtx, translation);
 					}
 					
-					// Create mesh matrix
+					// Create mesh matrix, relative to the mesh's node if it has one
 					F32 meshMtx[16];
 					mara::getMeshTransform(meshMtx, mesh);
+					if (NULL != record && record->node < prefab->m_nodes.getNumNodes())
+					{
+						base::mtxMul(meshMtx, meshMtx, prefab->m_nodes.getWorld(record->node));
+					}
 
 					// Calculate final matrix
 					F32 mtx[16];
 					base::mtxMul(mtx, entityMtx, meshMtx);
 
-					// Set final transformation matrix
-					graphics::setTransform(mtx);
+					// Pick LOD level when reaching the first level of a mesh, draw only the picked level
+					if (NULL != record && record->numLods > 1)
+					{
+						if (record->lod == 0 && NULL == activeCamera)
+						{
+							prefab->m_lods[i] = 0;
+						}
+						else if (record->lod == 0)
+						{
+							const F32 pixelsPerUnit = getPixelsPerUnit(mtx, *record, activeCamera, projScale);
+							prefab->m_lods[i] = 0 != (record->lodFlags & pakx::kLodAuthored)
+								? selectAuthoredLod(record, prefab->m_lods[i], mtx, activeCamera, pixelsPerUnit, F32(renderStats->height))
+								: selectLod(record, prefab->m_lods[i], pixelsPerUnit);
+						}
+
+						if (record->lod != prefab->m_lods[i - record->lod])
+						{
+							continue;
+						}
+					}
+
+					// Cull against the bounding sphere, then against the meshlets when there are any
+					if (NULL != record && NULL != activeCamera)
+					{
+						s_cullingStats.numMeshes++;
+
+						const F32 scale = base::max(base::length({ mtx[0], mtx[1], mtx[2] }),
+							base::max(base::length({ mtx[4], mtx[5], mtx[6] }), base::length({ mtx[8], mtx[9], mtx[10] })));
+						const base::Vec3 center = base::mul({ record->center[0], record->center[1], record->center[2] }, mtx);
+						bool isVisible = demo::isSphereVisible(frustum, center, record->radius * scale);
+
+						const pakx::Meshlet* meshlets = s_pakx->getMeshlets(*record);
+						if (isVisible && NULL != meshlets)
+						{
+							const U32 numVisible = demo::cullMeshlets(meshlets, record->numMeshlets, mtx, frustum, activeCamera->m_position, s_meshletConeCulling);
+							s_cullingStats.numMeshlets += record->numMeshlets;
+							s_cullingStats.numVisibleMeshlets += numVisible;
+							isVisible = numVisible > 0;
+						}
+
+						if (!isVisible)
+						{
+							s_cullingStats.numCulledMeshes++;
+							continue;
+						}
+					}
+
+					// Request the texture mip needed for the size on screen
+					if (NULL != record && record->texture != pakx::kInvalidIndex)
+					{
+						const F32 screenSize = NULL != activeCamera
+							? record->radius * getPixelsPerUnit(mtx, *record, activeCamera, projScale)
+							: 0.0f;
+
+						s_textureStreamer.request(record->texture, screenSize);
+					}
+
+					// Pose blend shapes of drawn meshes only
+					const demo::MorphInstance* morph = NULL;
+					if (NULL != record && record->numMorphTargets > 0)
+					{
+						demo::MorphInstance& instance = prefab->m_morphs[i];
+						for (U32 j = 0; j < instance.weights.size(); j++)
+						{
+							instance.weights[j] = s_animateMorphTargets ? 0.5f - 0.5f * base::cos(s_morphTime * 2.0f + F32(j)) : 0.0f;
+						}
+
+						s_morphTargets.update(instance, *record);
+						morph = graphics::isValid(instance.texture) ? &instance : NULL;
+					}
 
-					// Submit mesh for rendering
-					graphics::submit(0, mesh);
+					// Queue mesh, draws are submitted sorted by program and material
+					DrawItem item;
+					item.mesh = mesh;
+					item.record = record;
+					item.morph = morph;
+					item.isMorphed = NULL != record && record->numMorphTargets > 0;
+					item.sortKey = NULL != record ? (U64(record->program) << 48) | (U64(record->material & 0xFFFFFFFF) << 16) | mesh.idx : 0;
+					base::memCopy(item.mtx, mtx, sizeof(mtx));
+					s_drawList.push_back(item);
 				}
 			}
 
+			std::stable_sort(s_drawList.begin(), s_drawList.end(), [](const DrawItem& _a, const DrawItem& _b)
+				{
+					return _a.sortKey < _b.sortKey;
+				});
+
+			// Submit queued meshes, material blocks are only uploaded when the material changes
+			U32 uploadedMaterial = pakx::kInvalidIndex;
+			for (U32 first = 0; first < s_drawList.size();)
+			{
+				const DrawItem& item = s_drawList[first];
+
+				// Instanced meshes take every following draw of the same mesh, morphed meshes have their own deltas
+				const bool isInstanced = s_instancedDrawing && NULL != item.record && !item.isMorphed;
+				U32 numInstances = 1;
+				if (isInstanced)
+				{
+					while (first + numInstances < s_drawList.size() && s_drawList[first + numInstances].mesh.idx == item.mesh.idx)
+					{
+						numInstances++;
+					}
+
+					numInstances = graphics::getAvailInstanceDataBuffer(numInstances, sizeof(item.mtx));
+					if (numInstances == 0)
+					{
+						break;
+					}
+				}
+
+				// Set render state for mesh
+				const U64 state = 0 | GRAPHICS_STATE_WRITE_RGB
+					| GRAPHICS_STATE_WRITE_A
+					| GRAPHICS_STATE_WRITE_Z
+					| GRAPHICS_STATE_DEPTH_TEST_LESS
+					| GRAPHICS_STATE_MSAA;
+				graphics::setState(state);
+
+				// Set final transformation matrices
+				if (isInstanced)
+				{
+					graphics::InstanceDataBuffer idb;
+					graphics::allocInstanceDataBuffer(&idb, numInstances, sizeof(item.mtx));
+					for (U32 i = 0; i < numInstances; i++)
+					{
+						base::memCopy(&idb.data[i * sizeof(item.mtx)], s_drawList[first + i].mtx, sizeof(item.mtx));
+					}
+					graphics::setInstanceDataBuffer(&idb);
+				}
+				else
+				{
+					graphics::setTransform(item.mtx);
+				}
+
+				// Upload packed material uniforms, uniforms keep their value for the following draws
+				const pakx::MaterialBlock* material = NULL != item.record ? s_pakx->getMaterial(item.record->material) : NULL;
+				if (NULL != material && item.record->material != uploadedMaterial)
+				{
+					graphics::setUniform(s_materialUniform, material, pakx::kMaterialBlockVec4s);
+					uploadedMaterial = item.record->material;
+					s_drawStats.numMaterialUploads++;
+				}
+
+				// Bind texture array or streamed texture
+				if (NULL != item.record && item.record->textureArray != pakx::kInvalidIndex)
+				{
+					s_textureArrays.bind(0, s_diffuseSampler, item.record->textureArray);
+				}
+				else if (NULL != item.record && item.record->texture != pakx::kInvalidIndex)
+				{
+					s_textureStreamer.bind(0, s_diffuseSampler, item.record->texture);
+				}
+				else if (NULL == item.record)
+				{
+					// Without .pakx data the material variant is unknown, keep the sampler valid
+					graphics::setTexture(0, s_diffuseSampler, s_defaultTexture);
+				}
+
+				if (NULL != item.morph)
+				{
+					s_morphTargets.bind(1, s_morphSampler, s_morphUniform, *item.morph);
+				}
+				else if (item.isMorphed)
+				{
+					// No deltas, the morph shader must not see the previous draw's uniform
+					const F32 params[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
+					graphics::setUniform(s_morphUniform, params);
+					graphics::setTexture(1, s_morphSampler, s_defaultTexture);
+				}
+
+				// Submit mesh for rendering
+				graphics::submit(0, item.mesh);
+				s_drawStats.numDraws++;
+				s_drawStats.numInstances += numInstances;
+				first += numInstances;
+			}
+
 			// Make sure we still clear screen if nothing is loaded.
 			// We have to call touch, since we have nothing to submit.
 			if (qr->m_count <= 0)
@@ -232,6 +841,8 @@ namespace
 
 	void input(F32 _dt, bool _enableInput)
 	{
+		DEMO_PROFILER_SCOPE("input");
+
 		// Modifies entity's transform and camera component from input.
 		// 
 		// This system requires these components:
@@ -343,6 +954,8 @@ namespace
 
 	void camera(F32 _dt)
 	{
+		DEMO_PROFILER_SCOPE("camera");
+
 		// Calculate camera camera and sends data to GPU.
 		// 
 		// This system requires these components:
@@ -393,6 +1006,8 @@ namespace
 
 	void movement(F32 _dt)
 	{
+		DEMO_PROFILER_SCOPE("movement");
+
 		mara::EntityQuery* qr = mara::queryEntities(COMPONENT_MOVEMENT | COMPONENT_TRANSFORM);
 		{
 			for (U32 i = 0; i < qr->m_count; i++)
@@ -470,10 +1085,20 @@ namespace
 	class Game : public entry::AppI
 	{
 	public:
+		static constexpr U64 kTextureBudget = 256 << 20;
+		static constexpr U32 kMaxTimelineZones = 64;
+		static constexpr U32 kTimelineWidth = 40;
+		static constexpr U32 kResourcesPerPage = 20;
+		static constexpr U32 kBenchmarkEntities = 1000;
+		static constexpr U32 kBenchmarkWarmupFrames = 60;
+		static constexpr U32 kBenchmarkFrames = 1000;
+		static constexpr F32 kBenchmarkDeltaTime = 1.0f / 60.0f; // Fixed so every run simulates the same
+
 		Game(const char* _name, const char* _description)
 			: entry::AppI(_name, _description)
 			, m_scene(MARA_INVALID_HANDLE)
 			, m_character(MARA_INVALID_HANDLE)
+			, m_isLoadBenchmark(false)
 		{
 			// Set window title
 			entry::setWindowTitle(entry::kDefaultWindowHandle, _name);
@@ -491,71 +1116,196 @@ namespace
 #endif
 			m_debug.menu = false;
 			m_debug.menuType = Debug::Default;
+			m_debug.resourcePage = 0;
 		}
 
 		void init(I32 _argc, const char* const* _argv, U32 _width, U32 _height) override
 		{
+			demo::profilerSetThreadName("Main");
+			initDataDir(_argc, _argv);
+
 			// Init Engine
 			mara::Init maraInit;
+#if DEMO_CONFIG_BENCHMARK
+			maraInit.graphicsApi = graphics::RendererType::Noop;
+#else
 			maraInit.graphicsApi = graphics::RendererType::Direct3D11;
+#endif // DEMO_CONFIG_BENCHMARK
 			maraInit.resolution.width = _width;
 			maraInit.resolution.height = _height;
 			mara::init(maraInit);
 
+#if DEMO_CONFIG_BENCHMARK
+			// Nothing of the demo may be loaded yet, the generated PAK would pack it and cold runs would find it resident
+			m_isLoadBenchmark = runLoadBenchmark(_argc, _argv);
+			if (m_isLoadBenchmark)
+			{
+				return;
+			}
+#endif // DEMO_CONFIG_BENCHMARK
+
 			// Create ImGui
 			mara::imguiCreate();
 
+			// Open sidecar, program bytecode is read while the PAK loads
+			const bool hasPakx = s_pakx->open(getDataPath("assets.pakx"));
+			if (hasPakx)
+			{
+				s_programCache.init(s_pakx);
+			}
+#if DEMO_CONFIG_BENCHMARK
+			else
+			{
+				BASE_TRACE("Benchmark: No assets in %s, timings are of an empty scene. Pass --data <dir>", s_dataDir.c_str())
+			}
+#endif // DEMO_CONFIG_BENCHMARK
+
+			// Track resource memory from before the PAK loads so first seen times are relative to startup
+			initResourceStats(hasPakx ? s_pakx : NULL);
+			s_prefabResources.init(kMaxPrefabResources, destroyPrefabResource);
+
 			// Load PAK
-			mara::loadPak("C:/Users/marcu/Dev/mara-demo/demo/build/bin/data/assets.pak");
+			{
+				DEMO_PROFILER_SCOPE("mara::loadPak");
+				mara::loadPak(getDataPath("assets.pak"));
+			}
+
+			// Create all programs before materials load, then start streaming textures
+			s_diffuseSampler = graphics::createUniform("s_diffuse", graphics::UniformType::Sampler);
+			s_materialUniform = graphics::createUniform("u_material", graphics::UniformType::Vec4, pakx::kMaterialBlockVec4s);
+			s_morphSampler = graphics::createUniform("s_morph", graphics::UniformType::Sampler);
+			s_morphUniform = graphics::createUniform("u_morph", graphics::UniformType::Vec4);
+			if (hasPakx)
+			{
+				s_programCache.warm();
+				s_textureStreamer.init(s_pakx, kTextureBudget);
+				s_morphTargets.init(s_pakx);
+
+				// Texture arrays replace per material textures, meshes are then drawn instanced
+				if (s_pakx->hasChunk(pakx::kChunkTextureArrays))
+				{
+					s_textureArrays.init(s_pakx);
+					s_instancedDrawing = 0 != (graphics::getCaps()->supported & GRAPHICS_CAPS_INSTANCING);
+				}
+			}
+
+			// Assets rebuilt by the resource compiler are picked up while running
+			if (hasPakx)
+			{
+				if (!s_fileWatcher.init(s_dataDir.c_str()))
+				{
+					BASE_TRACE("Hot reload is off, %s can't be watched for changes", s_dataDir.c_str())
+				}
+			}
+
+			{
+				const U32 white = 0xFFFFFFFF;
+				s_defaultTexture = graphics::createTexture2D(1, 1, false, 1, graphics::TextureFormat::RGBA8, 0, graphics::copy(&white, sizeof(white)));
+			}
 
 			// Create Scene
 			m_scene = mara::createEntity();
 			{
-				PrefabComponent* prefabComp = new PrefabComponent();
-				prefabComp->m_ph = mara::createPrefab(mara::loadPrefab("scenes/scene.bin"));
+				PrefabComponent* prefabComp = new PrefabComponent("scenes/scene.bin");
 
 				mara::addComponent(m_scene, COMPONENT_PREFAB, mara::createComponent(prefabComp));
 			}
 
 			// Create Character
-			m_character = mara::createEntity();
+			m_character = createCharacter({ 0.0f, 0.5f, 0.0f }, true);
+
+#if DEMO_CONFIG_BENCHMARK
+			// Benchmark crowd on a grid around the character, all driven by the same input
+			const char* entities = demo::benchmarkGetArg(_argc, _argv, "--entities");
+			const char* frames = demo::benchmarkGetArg(_argc, _argv, "--frames");
+			const U32 numEntities = NULL != entities ? base::max(std::atoi(entities), 1) : kBenchmarkEntities;
+			const U32 numFrames = NULL != frames ? base::max(std::atoi(frames), 1) : kBenchmarkFrames;
+
+			const U32 gridSize = (U32)base::ceil(base::sqrt(F32(numEntities)));
+			for (U32 i = 1; i < numEntities; i++)
 			{
-				CameraComponent* cameraComp = new CameraComponent();
-				cameraComp->m_isActive = true;
-				cameraComp->m_speed = 3.0f;
-				cameraComp->m_armLength = 4.0f;
-				cameraComp->m_offset = { -0.5f, 1.0f, 0.0f };
+				const base::Vec3 position = { F32(i % gridSize) * 2.0f, 0.5f, F32(i / gridSize) * 2.0f };
+				m_benchmarkEntities.push_back(createCharacter(position, false));
+			}
+			s_benchmark.init(numEntities, kBenchmarkWarmupFrames, numFrames);
+#endif // DEMO_CONFIG_BENCHMARK
+		}
+
+		mara::EntityHandle createCharacter(const base::Vec3& _position, bool _isActive)
+		{
+			mara::EntityHandle character = mara::createEntity();
 
-				PrefabComponent* prefabComp = new PrefabComponent();
-				prefabComp->m_ph = mara::createPrefab(mara::loadPrefab("characters/character.bin"));
+			CameraComponent* cameraComp = new CameraComponent();
+			cameraComp->m_isActive = _isActive;
+			cameraComp->m_speed = 3.0f;
+			cameraComp->m_armLength = 4.0f;
+			cameraComp->m_offset = { -0.5f, 1.0f, 0.0f };
 
-				TransformComponent* transComp = new TransformComponent();
-				transComp->m_position = { 0.0f, 0.5f, 0.0f };
-				transComp->m_scale = { 0.01f, 0.01f, 0.01f };
+			PrefabComponent* prefabComp = new PrefabComponent("characters/character.bin");
 
-				MovementComponent* moveComp = new MovementComponent();
-				moveComp->speed = 1.0f;
+			TransformComponent* transComp = new TransformComponent();
+			transComp->m_position = _position;
+			transComp->m_scale = { 0.01f, 0.01f, 0.01f };
 
-				TrajectoryComponent* trajComp = new TrajectoryComponent();
+			MovementComponent* moveComp = new MovementComponent();
+			moveComp->speed = 1.0f;
 
-				mara::addComponent(m_character, COMPONENT_CAMERA, mara::createComponent(cameraComp));
-				mara::addComponent(m_character, COMPONENT_PREFAB, mara::createComponent(prefabComp));
-				mara::addComponent(m_character, COMPONENT_TRANSFORM, mara::createComponent(transComp));
-				mara::addComponent(m_character, COMPONENT_MOVEMENT, mara::createComponent(moveComp));
-				mara::addComponent(m_character, COMPONENT_TRAJECTORY, mara::createComponent(trajComp));
-			}
+			TrajectoryComponent* trajComp = new TrajectoryComponent();
+
+			mara::addComponent(character, COMPONENT_CAMERA, mara::createComponent(cameraComp));
+			mara::addComponent(character, COMPONENT_PREFAB, mara::createComponent(prefabComp));
+			mara::addComponent(character, COMPONENT_TRANSFORM, mara::createComponent(transComp));
+			mara::addComponent(character, COMPONENT_MOVEMENT, mara::createComponent(moveComp));
+			mara::addComponent(character, COMPONENT_TRAJECTORY, mara::createComponent(trajComp));
+
+			return character;
 		}
 
 		I32 shutdown() override
 		{
+#if DEMO_CONFIG_BENCHMARK
+			// Load benchmark returned from init before the demo loaded anything
+			if (m_isLoadBenchmark)
+			{
+				demo::profilerShutdown();
+				mara::shutdown();
+				return 0;
+			}
+#endif // DEMO_CONFIG_BENCHMARK
+
 			// Destroy Scene
 			mara::destroy(m_scene);
 
 			// Destroy Character
 			mara::destroy(m_character);
+			for (mara::EntityHandle entity : m_benchmarkEntities)
+			{
+				mara::destroy(entity);
+			}
+
+			// Prefabs released by the entities above
+			s_prefabResources.shutdown();
+			s_fileWatcher.shutdown();
+
+			// Stop streaming
+			s_textureStreamer.shutdown();
+			s_programCache.shutdown();
+			s_textureArrays.shutdown();
+			s_resourceStats.shutdown();
+			s_morphTargets.shutdown();
+			s_pakx->close();
+			demo::profilerShutdown();
+			graphics::destroy(s_diffuseSampler);
+			graphics::destroy(s_materialUniform);
+			graphics::destroy(s_morphSampler);
+			graphics::destroy(s_morphUniform);
+			if (graphics::isValid(s_defaultTexture))
+			{
+				graphics::destroy(s_defaultTexture);
+			}
 
 			// Unload PAK
-			mara::unloadPak("C:/Users/marcu/Dev/mara-demo/demo/build/bin/data/assets.pak");
+			mara::unloadPak(getDataPath("assets.pak"));
 
 			// Destroy ImGui
 			mara::imguiDestroy();
@@ -566,24 +1316,176 @@ namespace
 			return 0;
 		}
 
+		void reload()
+		{
+			DEMO_PROFILER_SCOPE("reload");
+
+			const F64 start = F64(base::getHPCounter());
+
+			// Rebuilt sidecar opens next to the one in use, a file that fails to open leaves the loaded build running
+			demo::PakxReader* pakx = s_pakx == &s_pakxFiles[0] ? &s_pakxFiles[1] : &s_pakxFiles[0];
+			if (!pakx->open(getDataPath("assets.pakx")))
+			{
+				BASE_TRACE("Failed: Reloading %s, keeping the loaded build", getDataPath("assets.pakx").getCPtr())
+				return;
+			}
+
+			// Content of the prefabs as they are loaded now
+			std::unordered_map<U32, U32> contentHashes;
+			{
+				U32 numPrefabs = 0;
+				const pakx::Prefab* prefabs = s_pakx->getPrefabs(&numPrefabs);
+				for (U32 i = 0; i < numPrefabs; i++)
+				{
+					contentHashes[prefabs[i].vfpHash] = prefabs[i].contentHash;
+				}
+			}
+
+			// Everything built from the sidecar starts over, indices into it change with every build
+			s_textureStreamer.shutdown();
+			s_textureArrays.shutdown();
+			s_morphTargets.shutdown();
+			s_programCache.shutdown();
+			s_pakx->close();
+			s_pakx = pakx;
+
+			// Remounting points the PAK entries at the rebuilt file, resources loaded from the old one keep their data
+			s_programCache.init(s_pakx);
+			mara::unloadPak(getDataPath("assets.pak"));
+			mara::loadPak(getDataPath("assets.pak"));
+			s_programCache.warm();
+			s_textureStreamer.init(s_pakx, kTextureBudget);
+			s_morphTargets.init(s_pakx);
+			s_instancedDrawing = false;
+			if (s_pakx->hasChunk(pakx::kChunkTextureArrays))
+			{
+				s_textureArrays.init(s_pakx);
+				s_instancedDrawing = 0 != (graphics::getCaps()->supported & GRAPHICS_CAPS_INSTANCING);
+			}
+			initResourceStats(s_pakx);
+
+			// Loaded prefabs swap behind their handles, only those whose sources, settings or shaders changed load again
+			U32 numPrefabs = 0;
+			U32 numLoaded = 0;
+			U32 numReloaded = 0;
+			const pakx::Prefab* prefabs = s_pakx->getPrefabs(&numPrefabs);
+			for (U32 i = 0; i < numPrefabs; i++)
+			{
+				// Prefabs new in this build, or no longer shown, load when a component asks for them
+				const demo::ResourceRef ref = s_prefabResources.find(prefabs[i].vfpHash);
+				if (!demo::isValid(ref))
+				{
+					continue;
+				}
+
+				PrefabResource* previous = (PrefabResource*)s_prefabResources.get(ref);
+				if (NULL == previous)
+				{
+					s_prefabResources.release(ref);
+					continue;
+				}
+
+				auto it = contentHashes.find(prefabs[i].vfpHash);
+				const bool isChanged = it == contentHashes.end() || it->second != prefabs[i].contentHash;
+				s_prefabResources.replace(ref, createPrefabResource(previous->vfp.c_str(), isChanged ? NULL : previous));
+				s_prefabResources.release(ref);
+
+				numLoaded++;
+				numReloaded += isChanged ? 1 : 0;
+			}
+
+			s_numReloads++;
+			BASE_TRACE("Reloaded %d of %d prefabs in %.1f ms", numReloaded, numLoaded,
+				(F64(base::getHPCounter()) - start) * 1000.0 / F64(base::getHPFrequency()))
+		}
+
 		bool update() override
 		{
+			demo::profilerBeginFrame();
+#if DEMO_CONFIG_BENCHMARK
+			// Load benchmark is done by the time init returns
+			if (m_isLoadBenchmark)
+			{
+				return false;
+			}
+			s_benchmark.beginFrame();
+#endif // DEMO_CONFIG_BENCHMARK
+
 			// Update
-			if (mara::update(GRAPHICS_DEBUG_TEXT, GRAPHICS_RESET_VSYNC))
+			bool isRunning;
 			{
+				DEMO_PROFILER_SCOPE("mara::update");
+				isRunning = mara::update(GRAPHICS_DEBUG_TEXT, GRAPHICS_RESET_VSYNC);
+			}
+
+			if (isRunning)
+			{
+				// Compiler writes the sidecar after the PAK, once it's closed both are complete
+				if (s_fileWatcher.hasChanged("assets.pakx"))
+				{
+					reload();
+				}
+
+#if DEMO_CONFIG_BENCHMARK
+				// Scripted gamepad replaces the device
+				demo::BenchmarkInput script;
+				demo::benchmarkGetInput(script, s_benchmark.getFrame());
+				inputSetGamepadAxis({ 0 }, entry::GamepadAxis::LeftX, script.leftX);
+				inputSetGamepadAxis({ 0 }, entry::GamepadAxis::LeftY, script.leftY);
+				inputSetGamepadAxis({ 0 }, entry::GamepadAxis::RightX, script.rightX);
+				inputSetGamepadAxis({ 0 }, entry::GamepadAxis::RightY, script.rightY);
+				inputSetKeyState(entry::Key::GamepadShoulderL, 0, script.shoulderLeft);
+				inputSetKeyState(entry::Key::GamepadShoulderR, 0, script.shoulderRight);
+				const F32 dt = kBenchmarkDeltaTime;
+#else
+				const F32 dt = mara::getDeltaTime();
+#endif // DEMO_CONFIG_BENCHMARK
+
 				// Debug
 				mara::imguiBeginFrame();
-				debug(mara::getDeltaTime());
+				debug(dt);
 				mara::imguiEndFrame();
 
 				// Systems
-				camera(mara::getDeltaTime());
-				input(mara::getDeltaTime(), !m_debug.menu);
-				movement(mara::getDeltaTime());
-				render(mara::getDeltaTime());
+				{
+					DEMO_BENCHMARK_SCOPE(s_benchmark, demo::BenchmarkSystem::Camera);
+					camera(dt);
+				}
+				{
+					DEMO_BENCHMARK_SCOPE(s_benchmark, demo::BenchmarkSystem::Input);
+					input(dt, !m_debug.menu);
+				}
+				{
+					DEMO_BENCHMARK_SCOPE(s_benchmark, demo::BenchmarkSystem::Movement);
+					movement(dt);
+				}
+				{
+					DEMO_BENCHMARK_SCOPE(s_benchmark, demo::BenchmarkSystem::Render);
+					render(dt);
+				}
+
+				// Stream in textures requested while rendering
+				s_textureStreamer.update();
+				s_resourceStats.update();
 
 				// Swap buffers
-				graphics::frame();
+				{
+					DEMO_PROFILER_SCOPE("graphics::frame");
+					graphics::frame();
+				}
+
+				// Resources released this frame are no longer referenced by submitted draws
+				s_prefabResources.collect();
+
+#if DEMO_CONFIG_BENCHMARK
+				s_benchmark.endFrame();
+				if (s_benchmark.isDone())
+				{
+					s_benchmark.writeJson("benchmark_systems.json");
+					s_benchmark.printSummary();
+					return false;
+				}
+#endif // DEMO_CONFIG_BENCHMARK
 
 				return true;
 			}
@@ -593,6 +1495,8 @@ namespace
 
 		void debug(F32 _dt)
 		{
+			DEMO_PROFILER_SCOPE("debug");
+
 			// Toggle debug menu
 			if (inputGetKeyState(entry::Key::GamepadThumbL) && inputGetKeyState(entry::Key::GamepadThumbR))
 			{
@@ -633,6 +1537,35 @@ namespace
 					case Debug::Rendering:
 					{
 						ImGui::BeginDeveloperMenu("Rendering");
+						{
+							const demo::TextureStreamer::Stats& stats = s_textureStreamer.getStats();
+
+							char formattedString[256];
+							base::snprintf(formattedString, sizeof(formattedString), "Streamed Textures: %d (%d pending)", stats.numTextures, stats.numPendingReads);
+							ImGui::DeveloperMenuText(formattedString);
+							base::snprintf(formattedString, sizeof(formattedString), "Texture Memory: %.1f / %.1f MB", F64(stats.residentBytes) / (1 << 20), F64(stats.budgetBytes) / (1 << 20));
+							ImGui::DeveloperMenuText(formattedString);
+							base::snprintf(formattedString, sizeof(formattedString), "Texture Uploads: %d, Evictions: %d", stats.numUploads, stats.numEvictions);
+							ImGui::DeveloperMenuText(formattedString);
+
+							base::snprintf(formattedString, sizeof(formattedString), "Programs: %d (warmed in %.1f ms)", s_programCache.getNumPrograms(), s_programCache.getWarmTimeMs());
+							ImGui::DeveloperMenuText(formattedString);
+
+							ImGui::DeveloperMenuCheckbox("Meshlet Cone Culling", &s_meshletConeCulling);
+							base::snprintf(formattedString, sizeof(formattedString), "Culled Meshes: %d / %d", s_cullingStats.numCulledMeshes, s_cullingStats.numMeshes);
+							ImGui::DeveloperMenuText(formattedString);
+							base::snprintf(formattedString, sizeof(formattedString), "Visible Meshlets: %d / %d", s_cullingStats.numVisibleMeshlets, s_cullingStats.numMeshlets);
+							ImGui::DeveloperMenuText(formattedString);
+							base::snprintf(formattedString, sizeof(formattedString), "Draws: %d (%d instances), Material Uploads: %d", s_drawStats.numDraws, s_drawStats.numInstances, s_drawStats.numMaterialUploads);
+							ImGui::DeveloperMenuText(formattedString);
+
+							const demo::MorphTargets::Stats& morphStats = s_morphTargets.getStats();
+							ImGui::DeveloperMenuCheckbox("Animate Blend Shapes", &s_animateMorphTargets);
+							base::snprintf(formattedString, sizeof(formattedString), "Blend Shapes: %d targets, %d deltas", morphStats.numTargets, morphStats.numDeltas);
+							ImGui::DeveloperMenuText(formattedString);
+							base::snprintf(formattedString, sizeof(formattedString), "Evaluated: %d targets, %d deltas, %d uploads", morphStats.numEvaluatedTargets, morphStats.numEvaluatedDeltas, morphStats.numUploads);
+							ImGui::DeveloperMenuText(formattedString);
+						}
 						ImGui::EndDeveloperMenu();
 						break;
 					}
@@ -640,6 +1573,47 @@ namespace
 					case Debug::Engine:
 					{
 						ImGui::BeginDeveloperMenu("Engine");
+						{
+							char formattedString[256];
+
+							// Frame times of the last few seconds
+							F64 maxFrameMs = 0.0;
+							for (U32 i = 0; i < demo::profilerGetNumFrameTimes(); i++)
+							{
+								maxFrameMs = base::max(maxFrameMs, demo::profilerGetFrameTimeMs(i));
+							}
+							base::snprintf(formattedString, sizeof(formattedString), "Frame: %.2f ms (max %.2f ms)", demo::profilerGetFrameTimeMs(0), maxFrameMs);
+							ImGui::DeveloperMenuText(formattedString);
+
+							if (ImGui::DeveloperMenuButton("Export Chrome Trace"))
+							{
+								demo::profilerExportChromeTrace("profile.json");
+							}
+
+							// Timeline of the main thread, zones are placed by when they ran inside the last frame
+							demo::ProfilerZone zones[kMaxTimelineZones];
+							I64 frameBegin;
+							I64 frameEnd;
+							const U32 numZones = demo::profilerGetLastFrame(zones, kMaxTimelineZones, &frameBegin, &frameEnd);
+							const F64 frameLength = F64(base::max<I64>(frameEnd - frameBegin, 1));
+							const F64 toMs = 1000.0 / F64(base::getHPFrequency());
+							for (U32 i = 0; i < numZones; i++)
+							{
+								const demo::ProfilerZone& zone = zones[i];
+
+								char bar[kTimelineWidth + 1];
+								const U32 first = base::min<U32>(U32(F64(zone.begin - frameBegin) / frameLength * kTimelineWidth), kTimelineWidth - 1);
+								const U32 last = base::max<U32>(base::min<U32>(U32(F64(zone.end - frameBegin) / frameLength * kTimelineWidth), kTimelineWidth - 1), first);
+								for (U32 j = 0; j < kTimelineWidth; j++)
+								{
+									bar[j] = (j >= first && j <= last) ? '#' : '.';
+								}
+								bar[kTimelineWidth] = '\0';
+
+								base::snprintf(formattedString, sizeof(formattedString), "|%s| %*s%s %.2f ms", bar, zone.depth * 2, "", zone.name, F64(zone.end - zone.begin) * toMs);
+								ImGui::DeveloperMenuText(formattedString);
+							}
+						}
 						ImGui::EndDeveloperMenu();
 						break;
 					}
@@ -671,13 +1645,82 @@ namespace
 					case Debug::BinFiles:
 					{
 						ImGui::BeginDeveloperMenu("Bin Files");
-						mara::ResourceInfo info[100];
-						U32 num = mara::getResourceInfo(info, true);
-						for (U32 i = 0; i < num; i++)
 						{
 							char formattedString[2048];
-							base::snprintf(formattedString, sizeof(formattedString), "%s [%d]", info[i].vfp.getCPtr(), info[i].refCount);
+
+							// Totals per type against their budgets
+							for (U32 i = 0; i <= pakx::ResourceType::Count; i++)
+							{
+								const pakx::ResourceType::Enum type = (pakx::ResourceType::Enum)i;
+								const demo::ResourceStats::Totals& totals = s_resourceStats.getTotals(type);
+								const U64 bytes = totals.cpuBytes + totals.gpuBytes;
+
+								const char* warning = "";
+								if (totals.budgetBytes > 0 && bytes > totals.budgetBytes)
+								{
+									warning = " OVER BUDGET";
+								}
+								else if (totals.budgetBytes > 0 && bytes * 10 > totals.budgetBytes * 8)
+								{
+									warning = " NEAR BUDGET";
+								}
+
+								base::snprintf(formattedString, sizeof(formattedString), "%s: %d, CPU %.2f MB, GPU %.2f MB, Budget %.1f MB%s",
+									demo::ResourceStats::getTypeName(type), totals.numResources, F64(totals.cpuBytes) / (1 << 20),
+									F64(totals.gpuBytes) / (1 << 20), F64(totals.budgetBytes) / (1 << 20), warning);
+								ImGui::DeveloperMenuText(formattedString);
+							}
+
+							const demo::TextureStreamer::Stats& streamStats = s_textureStreamer.getStats();
+							base::snprintf(formattedString, sizeof(formattedString), "Streamed Textures: GPU %.2f / %.1f MB, Texture Arrays: GPU %.2f MB",
+								F64(streamStats.residentBytes) / (1 << 20), F64(streamStats.budgetBytes) / (1 << 20),
+								F64(s_textureArrays.getMemoryBytes()) / (1 << 20));
+							ImGui::DeveloperMenuText(formattedString);
+
+							base::snprintf(formattedString, sizeof(formattedString), "Prefab Handles: %d live, %d waiting for frame end",
+								s_prefabResources.getNumResources(), s_prefabResources.getNumPending());
+							ImGui::DeveloperMenuText(formattedString);
+							base::snprintf(formattedString, sizeof(formattedString), "Hot Reloads: %d", s_numReloads);
+							ImGui::DeveloperMenuText(formattedString);
+
+							if (ImGui::DeveloperMenuButton("Export CSV"))
+							{
+								s_resourceStats.exportCsv("resources.csv");
+							}
+
+							// Resources largest first, a page at a time
+							const U32 numEntries = s_resourceStats.getNumEntries();
+							const U32 numPages = base::max<U32>((numEntries + kResourcesPerPage - 1) / kResourcesPerPage, 1);
+							m_debug.resourcePage = base::min(m_debug.resourcePage, numPages - 1);
+							if (ImGui::DeveloperMenuButton("Previous Page") && m_debug.resourcePage > 0)
+							{
+								m_debug.resourcePage--;
+							}
+							if (ImGui::DeveloperMenuButton("Next Page") && m_debug.resourcePage + 1 < numPages)
+							{
+								m_debug.resourcePage++;
+							}
+							base::snprintf(formattedString, sizeof(formattedString), "Page %d / %d (%d resources)", m_debug.resourcePage + 1, numPages, numEntries);
 							ImGui::DeveloperMenuText(formattedString);
+
+							const U32 first = m_debug.resourcePage * kResourcesPerPage;
+							const U32 last = base::min(first + kResourcesPerPage, numEntries);
+							for (U32 i = first; i < last; i++)
+							{
+								const demo::ResourceStats::Entry& entry = s_resourceStats.getEntry(i);
+								if (entry.isLoaded)
+								{
+									base::snprintf(formattedString, sizeof(formattedString), "%s [%d] %s, CPU %.1f KB, GPU %.1f KB, first seen at %.0f ms, used %d frames ago",
+										entry.vfp.getCPtr(), entry.refCount, demo::ResourceStats::getTypeName(entry.type), F64(entry.cpuBytes) / 1024.0,
+										F64(entry.gpuBytes) / 1024.0, entry.firstSeenMs, s_resourceStats.getFrame() - entry.lastUsedFrame);
+								}
+								else
+								{
+									base::snprintf(formattedString, sizeof(formattedString), "%s (unloaded) %s", entry.vfp.getCPtr(),
+										demo::ResourceStats::getTypeName(entry.type));
+								}
+								ImGui::DeveloperMenuText(formattedString);
+							}
 						}
 						ImGui::EndDeveloperMenu();
 						break;
@@ -762,6 +1805,8 @@ namespace
 
 		mara::EntityHandle m_scene;
 		mara::EntityHandle m_character;
+		std::vector<mara::EntityHandle> m_benchmarkEntities; // Crowd of the benchmark build
+		bool m_isLoadBenchmark; // Benchmark build ran the PAK load benchmark instead of the systems
 
 		struct Debug
 		{
@@ -783,6 +1828,8 @@ namespace
 
 			bool freeCamera;
 
+			U32 resourcePage;
+
 		} m_debug;
 	};
 
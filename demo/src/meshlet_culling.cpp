@@ -0,0 +1,91 @@
+#include "meshlet_culling.h"
+
+namespace demo
+{
+	void buildFrustum(Frustum& _frustum, const F32* _viewProj, bool _homogeneousDepth)
+	{
+		// Clip space is v * viewProj, so every plane is a combination of matrix columns
+		const F32* m = _viewProj;
+		const F32 col0[4] = { m[0], m[4], m[8],  m[12] };
+		const F32 col1[4] = { m[1], m[5], m[9],  m[13] };
+		const F32 col2[4] = { m[2], m[6], m[10], m[14] };
+		const F32 col3[4] = { m[3], m[7], m[11], m[15] };
+
+		for (U32 i = 0; i < 4; i++)
+		{
+			_frustum.planes[0][i] = col3[i] + col0[i]; // Left
+			_frustum.planes[1][i] = col3[i] - col0[i]; // Right
+			_frustum.planes[2][i] = col3[i] + col1[i]; // Bottom
+			_frustum.planes[3][i] = col3[i] - col1[i]; // Top
+			_frustum.planes[4][i] = _homogeneousDepth ? col3[i] + col2[i] : col2[i]; // Near
+			_frustum.planes[5][i] = col3[i] - col2[i]; // Far
+		}
+
+		for (U32 i = 0; i < 6; i++)
+		{
+			F32* plane = _frustum.planes[i];
+			const F32 length = base::length({ plane[0], plane[1], plane[2] });
+			const F32 invLength = length > 0.0f ? 1.0f / length : 0.0f;
+			plane[0] *= invLength;
+			plane[1] *= invLength;
+			plane[2] *= invLength;
+			plane[3] *= invLength;
+		}
+	}
+
+	bool isSphereVisible(const Frustum& _frustum, const base::Vec3& _center, F32 _radius)
+	{
+		for (U32 i = 0; i < 6; i++)
+		{
+			const F32* plane = _frustum.planes[i];
+			if (base::dot({ plane[0], plane[1], plane[2] }, _center) + plane[3] < -_radius)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	U32 cullMeshlets(const pakx::Meshlet* _meshlets, U32 _numMeshlets, const F32* _mtx, const Frustum& _frustum,
+		const base::Vec3& _cameraPosition, bool _coneCulling)
+	{
+		const F32 scaleX = base::length({ _mtx[0], _mtx[1], _mtx[2] });
+		const F32 scaleY = base::length({ _mtx[4], _mtx[5], _mtx[6] });
+		const F32 scaleZ = base::length({ _mtx[8], _mtx[9], _mtx[10] });
+		const F32 minScale = base::min(scaleX, base::min(scaleY, scaleZ));
+		const F32 maxScale = base::max(scaleX, base::max(scaleY, scaleZ));
+
+		// Cones only survive uniform scale, skip the test otherwise
+		const bool coneCulling = _coneCulling && maxScale <= minScale * 1.01f;
+
+		U32 numVisible = 0;
+		for (U32 i = 0; i < _numMeshlets; i++)
+		{
+			const pakx::Meshlet& meshlet = _meshlets[i];
+
+			const base::Vec3 center = base::mul({ meshlet.center[0], meshlet.center[1], meshlet.center[2] }, _mtx);
+			const F32 radius = meshlet.radius * maxScale;
+			if (!isSphereVisible(_frustum, center, radius))
+			{
+				continue;
+			}
+
+			// All triangles face away when the camera is inside the cone behind the meshlet
+			if (coneCulling && meshlet.coneCutoff < 1.0f)
+			{
+				const base::Vec3 axis = base::normalize(base::mulXyz0({ meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2] }, _mtx));
+				const base::Vec3 toCenter = base::sub(center, _cameraPosition);
+				if (base::dot(toCenter, axis) >= meshlet.coneCutoff * base::length(toCenter) + radius)
+				{
+					continue;
+				}
+			}
+
+			numVisible++;
+		}
+
+		return numVisible;
+	}
+
+} // namespace demo
@@ -0,0 +1,174 @@
+#include "morph_targets.h"
+#include "profiler.h"
+
+namespace demo
+{
+	namespace
+	{
+		constexpr U32 kMaxTextureWidth = 1024;
+
+		// Weights smaller than this don't move a vertex visibly and are skipped
+		constexpr F32 kMinWeight = 1.0f / 1024.0f;
+
+	} // namespace
+
+	MorphInstance::MorphInstance()
+		: texture(GRAPHICS_INVALID_HANDLE)
+		, width(0)
+		, height(0)
+		, numVertices(0)
+		, isActive(false)
+	{}
+
+	MorphTargets::MorphTargets()
+	{
+		base::memSet(&m_stats, 0, sizeof(m_stats));
+	}
+
+	MorphTargets::~MorphTargets()
+	{
+		shutdown();
+	}
+
+	bool MorphTargets::init(PakxReader* _reader)
+	{
+		DEMO_PROFILER_SCOPE("MorphTargets::init");
+
+		shutdown();
+
+		pakx::MorphsHeader header;
+		if (!_reader->read(pakx::kChunkMorphs, 0, &header, sizeof(header)))
+		{
+			return false;
+		}
+
+		m_targets.resize(header.numTargets);
+		m_deltas.resize(header.numDeltas);
+		_reader->read(pakx::kChunkMorphs, sizeof(header), m_targets.data(), (U32)(m_targets.size() * sizeof(pakx::MorphTarget)));
+		_reader->read(pakx::kChunkMorphs, (U32)(sizeof(header) + m_targets.size() * sizeof(pakx::MorphTarget)), m_deltas.data(),
+			(U32)(m_deltas.size() * sizeof(pakx::MorphDelta)));
+
+		m_stats.numTargets = header.numTargets;
+		m_stats.numDeltas = header.numDeltas;
+		return true;
+	}
+
+	void MorphTargets::shutdown()
+	{
+		m_targets.clear();
+		m_deltas.clear();
+		base::memSet(&m_stats, 0, sizeof(m_stats));
+	}
+
+	bool MorphTargets::createInstance(MorphInstance& _instance, const pakx::Mesh& _record) const
+	{
+		if (_record.numMorphTargets == 0 || _record.firstMorphTarget + _record.numMorphTargets > m_targets.size())
+		{
+			return false;
+		}
+
+		// Texture only covers vertices up to the last one any target moves
+		U32 numVertices = 0;
+		for (U32 i = 0; i < _record.numMorphTargets; i++)
+		{
+			const pakx::MorphTarget& target = m_targets[_record.firstMorphTarget + i];
+			for (U32 j = 0; j < target.numDeltas; j++)
+			{
+				numVertices = base::max(numVertices, m_deltas[target.firstDelta + j].vertex + 1);
+			}
+		}
+
+		if (numVertices == 0)
+		{
+			return false;
+		}
+
+		_instance.numVertices = numVertices;
+		_instance.width = (U16)base::min(numVertices, kMaxTextureWidth);
+		_instance.height = (U16)((numVertices + kMaxTextureWidth - 1) / kMaxTextureWidth);
+		_instance.texture = graphics::createTexture2D(_instance.width, _instance.height, false, 1, graphics::TextureFormat::RGBA16F,
+			GRAPHICS_SAMPLER_POINT | GRAPHICS_SAMPLER_UVW_CLAMP);
+		_instance.weights.assign(_record.numMorphTargets, 0.0f);
+		_instance.appliedWeights.assign(_record.numMorphTargets, -1.0f); // Forces the first update
+		_instance.isActive = false;
+
+		return true;
+	}
+
+	void MorphTargets::destroyInstance(MorphInstance& _instance) const
+	{
+		if (graphics::isValid(_instance.texture))
+		{
+			graphics::destroy(_instance.texture);
+			_instance.texture = GRAPHICS_INVALID_HANDLE;
+		}
+	}
+
+	void MorphTargets::update(MorphInstance& _instance, const pakx::Mesh& _record)
+	{
+		if (!graphics::isValid(_instance.texture) || _instance.weights == _instance.appliedWeights)
+		{
+			return;
+		}
+
+		DEMO_PROFILER_SCOPE("MorphTargets::update");
+
+		// Sum scaled deltas of active targets, cost scales with the vertices they move
+		m_sum.assign(_instance.width * _instance.height * 4, 0.0f);
+		_instance.isActive = false;
+		for (U32 i = 0; i < _record.numMorphTargets; i++)
+		{
+			const F32 weight = _instance.weights[i];
+			if (base::abs(weight) < kMinWeight)
+			{
+				continue;
+			}
+
+			const pakx::MorphTarget& target = m_targets[_record.firstMorphTarget + i];
+			const pakx::MorphDelta* deltas = &m_deltas[target.firstDelta];
+			const F32 scale = target.scale * weight;
+			for (U32 j = 0; j < target.numDeltas; j++)
+			{
+				F32* sum = &m_sum[deltas[j].vertex * 4];
+				sum[0] += F32(deltas[j].position[0]) * scale;
+				sum[1] += F32(deltas[j].position[1]) * scale;
+				sum[2] += F32(deltas[j].position[2]) * scale;
+			}
+
+			_instance.isActive = true;
+			m_stats.numEvaluatedTargets++;
+			m_stats.numEvaluatedDeltas += target.numDeltas;
+		}
+
+		if (_instance.isActive)
+		{
+			m_texels.resize(m_sum.size());
+			for (U32 i = 0; i < m_sum.size(); i++)
+			{
+				m_texels[i] = base::halfFromFloat(m_sum[i]);
+			}
+
+			graphics::updateTexture2D(_instance.texture, 0, 0, 0, 0, _instance.width, _instance.height,
+				graphics::copy(m_texels.data(), (U32)(m_texels.size() * sizeof(U16))));
+			m_stats.numUploads++;
+		}
+
+		_instance.appliedWeights = _instance.weights;
+	}
+
+	void MorphTargets::bind(U8 _stage, graphics::UniformHandle _sampler, graphics::UniformHandle _uniform, const MorphInstance& _instance) const
+	{
+		// Inactive instances keep the texture bound but fetch nothing
+		const F32 params[4] = { _instance.isActive ? F32(_instance.numVertices) : 0.0f, F32(_instance.width), 0.0f, 0.0f };
+		graphics::setUniform(_uniform, params);
+		graphics::setTexture(_stage, _sampler, _instance.texture);
+	}
+
+	void MorphTargets::resetStats()
+	{
+		m_stats.numEvaluatedTargets = 0;
+		m_stats.numEvaluatedDeltas = 0;
+		m_stats.numUploads = 0;
+	}
+
+} // namespace demo
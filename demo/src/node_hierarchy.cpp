@@ -0,0 +1,104 @@
+#include "node_hierarchy.h"
+#include "profiler.h"
+
+namespace demo
+{
+	NodeHierarchy::NodeHierarchy()
+		: m_parents(NULL)
+		, m_locals(NULL)
+		, m_worlds(NULL)
+		, m_numNodes(0)
+		, m_isDirty(false)
+	{}
+
+	NodeHierarchy::~NodeHierarchy()
+	{
+		shutdown();
+	}
+
+	void NodeHierarchy::init(const void* _nodes, U32 _numNodes)
+	{
+		shutdown();
+
+		if (NULL == _nodes || _numNodes == 0)
+		{
+			return;
+		}
+
+		// Transforms follow the parents, one copy takes all of them
+		m_parents = (const U32*)_nodes;
+		m_numNodes = _numNodes;
+		m_locals = new F32[_numNodes * 10];
+		m_worlds = new F32[_numNodes * 16];
+		base::memCopy(m_locals, m_parents + _numNodes, _numNodes * 10 * sizeof(F32));
+		m_isDirty = true;
+	}
+
+	void NodeHierarchy::shutdown()
+	{
+		delete[] m_locals;
+		delete[] m_worlds;
+
+		m_parents = NULL;
+		m_locals = NULL;
+		m_worlds = NULL;
+		m_numNodes = 0;
+		m_isDirty = false;
+	}
+
+	void NodeHierarchy::update()
+	{
+		if (!m_isDirty)
+		{
+			return;
+		}
+
+		DEMO_PROFILER_SCOPE("NodeHierarchy::update");
+
+		const F32* translations = m_locals;
+		const F32* rotations = m_locals + m_numNodes * 3;
+		const F32* scales = m_locals + m_numNodes * 7;
+		for (U32 i = 0; i < m_numNodes; i++)
+		{
+			const F32* t = &translations[i * 3];
+			const F32* s = &scales[i * 3];
+			const F32 x = rotations[i * 4 + 0];
+			const F32 y = rotations[i * 4 + 1];
+			const F32 z = rotations[i * 4 + 2];
+			const F32 w = rotations[i * 4 + 3];
+
+			// Scale, then rotate, then translate
+			F32 local[16];
+			local[0] = s[0] * (1.0f - 2.0f * (y * y + z * z));
+			local[1] = s[0] * (2.0f * (x * y + z * w));
+			local[2] = s[0] * (2.0f * (x * z - y * w));
+			local[3] = 0.0f;
+			local[4] = s[1] * (2.0f * (x * y - z * w));
+			local[5] = s[1] * (1.0f - 2.0f * (x * x + z * z));
+			local[6] = s[1] * (2.0f * (y * z + x * w));
+			local[7] = 0.0f;
+			local[8] = s[2] * (2.0f * (x * z + y * w));
+			local[9] = s[2] * (2.0f * (y * z - x * w));
+			local[10] = s[2] * (1.0f - 2.0f * (x * x + y * y));
+			local[11] = 0.0f;
+			local[12] = t[0];
+			local[13] = t[1];
+			local[14] = t[2];
+			local[15] = 1.0f;
+
+			F32* world = &m_worlds[i * 16];
+			const U32 parent = m_parents[i];
+			if (parent < i)
+			{
+				base::mtxMul(world, local, &m_worlds[parent * 16]);
+			}
+			else
+			{
+				base::memCopy(world, local, sizeof(local));
+			}
+		}
+
+		m_isDirty = false;
+	}
+
+} // namespace demo
@@ -0,0 +1,181 @@
+#include "pakx_reader.h"
+#include "profiler.h"
+
+namespace demo
+{
+	PakxReader::PakxReader()
+		: m_isOpen(false)
+	{}
+
+	PakxReader::~PakxReader()
+	{
+		close();
+	}
+
+	bool PakxReader::open(const base::FilePath& _filePath)
+	{
+		DEMO_PROFILER_SCOPE("PakxReader::open");
+
+		close();
+
+		base::Error err;
+		if (!base::open(&m_reader, _filePath, &err))
+		{
+			BASE_TRACE("Failed: Opening %s", _filePath.getCPtr())
+			return false;
+		}
+
+		pakx::Header header;
+		base::read(&m_reader, &header, sizeof(header), &err);
+		if (header.magic != pakx::kMagic || header.version != pakx::kVersion)
+		{
+			BASE_TRACE("Failed: %s is not a supported pakx file", _filePath.getCPtr())
+			base::close(&m_reader);
+			return false;
+		}
+
+		m_chunks.resize(header.numChunks);
+		base::read(&m_reader, m_chunks.data(), (I32)(header.numChunks * sizeof(pakx::Chunk)), &err);
+		m_isOpen = true;
+
+		// Prefab tables are small and looked up every frame, keep them in memory
+		pakx::PrefabsHeader prefabs;
+		if (read(pakx::kChunkPrefabs, 0, &prefabs, sizeof(prefabs)))
+		{
+			m_prefabs.resize(prefabs.numPrefabs);
+			m_meshes.resize(prefabs.numMeshes);
+
+			U32 offset = sizeof(pakx::PrefabsHeader);
+			read(pakx::kChunkPrefabs, offset, m_prefabs.data(), (U32)(m_prefabs.size() * sizeof(pakx::Prefab)));
+			offset += (U32)(m_prefabs.size() * sizeof(pakx::Prefab));
+			read(pakx::kChunkPrefabs, offset, m_meshes.data(), (U32)(m_meshes.size() * sizeof(pakx::Mesh)));
+		}
+
+		// Node hierarchies are copied by every prefab instance
+		const pakx::Chunk* nodes = findChunk(pakx::kChunkNodes);
+		if (NULL != nodes)
+		{
+			m_nodes.resize((size_t)nodes->size);
+			read(pakx::kChunkNodes, 0, m_nodes.data(), (U32)m_nodes.size());
+		}
+
+		// Meshlet culling data is used every frame too, vertex and triangle lists stay on disk
+		pakx::MeshletsHeader meshlets;
+		if (read(pakx::kChunkMeshlets, 0, &meshlets, sizeof(meshlets)))
+		{
+			m_meshlets.resize(meshlets.numMeshlets);
+			read(pakx::kChunkMeshlets, sizeof(pakx::MeshletsHeader), m_meshlets.data(), (U32)(m_meshlets.size() * sizeof(pakx::Meshlet)));
+		}
+
+		pakx::MaterialsHeader materials;
+		if (read(pakx::kChunkMaterials, 0, &materials, sizeof(materials)) && materials.numVec4s == pakx::kMaterialBlockVec4s)
+		{
+			m_materials.resize(materials.numMaterials);
+			read(pakx::kChunkMaterials, sizeof(pakx::MaterialsHeader), m_materials.data(), (U32)(m_materials.size() * sizeof(pakx::MaterialBlock)));
+		}
+
+		return err.isOk();
+	}
+
+	void PakxReader::close()
+	{
+		if (m_isOpen)
+		{
+			base::close(&m_reader);
+			m_isOpen = false;
+		}
+
+		m_chunks.clear();
+		m_prefabs.clear();
+		m_meshes.clear();
+		m_meshlets.clear();
+		m_nodes.clear();
+		m_materials.clear();
+	}
+
+	bool PakxReader::read(U32 _fourcc, U32 _offset, void* _dst, U32 _size)
+	{
+		DEMO_PROFILER_SCOPE("PakxReader::read");
+
+		const pakx::Chunk* chunk = findChunk(_fourcc);
+		if (NULL == chunk || _offset + _size > chunk->size)
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		base::Error err;
+		base::seek(&m_reader, (I64)(chunk->offset + _offset), base::Whence::Begin);
+		return base::read(&m_reader, _dst, (I32)_size, &err) == (I32)_size;
+	}
+
+	const pakx::Mesh* PakxReader::findPrefabMeshes(U32 _vfpHash, U32* _outNum) const
+	{
+		for (const pakx::Prefab& prefab : m_prefabs)
+		{
+			if (prefab.vfpHash == _vfpHash)
+			{
+				*_outNum = prefab.numMeshes;
+				return &m_meshes[prefab.firstMesh];
+			}
+		}
+
+		*_outNum = 0;
+		return NULL;
+	}
+
+	const pakx::Prefab* PakxReader::findPrefab(U32 _vfpHash) const
+	{
+		for (const pakx::Prefab& prefab : m_prefabs)
+		{
+			if (prefab.vfpHash == _vfpHash)
+			{
+				return &prefab;
+			}
+		}
+
+		return NULL;
+	}
+
+	const void* PakxReader::getNodes(const pakx::Prefab& _prefab) const
+	{
+		// Parents, translations, rotations and scales
+		const U64 size = U64(_prefab.numNodes) * (sizeof(U32) + 10 * sizeof(F32));
+		if (_prefab.numNodes == 0 || _prefab.nodeOffset + size > m_nodes.size())
+		{
+			return NULL;
+		}
+
+		return &m_nodes[_prefab.nodeOffset];
+	}
+
+	const pakx::Meshlet* PakxReader::getMeshlets(const pakx::Mesh& _record) const
+	{
+		if (_record.numMeshlets == 0 || _record.firstMeshlet + _record.numMeshlets > m_meshlets.size())
+		{
+			return NULL;
+		}
+
+		return &m_meshlets[_record.firstMeshlet];
+	}
+
+	const pakx::MaterialBlock* PakxReader::getMaterial(U32 _index) const
+	{
+		return _index < m_materials.size() ? &m_materials[_index] : NULL;
+	}
+
+	const pakx::Chunk* PakxReader::findChunk(U32 _fourcc) const
+	{
+		for (const pakx::Chunk& chunk : m_chunks)
+		{
+			if (chunk.fourcc == _fourcc)
+			{
+				return &chunk;
+			}
+		}
+
+		return NULL;
+	}
+
+} // namespace demo
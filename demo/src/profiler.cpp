@@ -0,0 +1,315 @@
+#include "profiler.h"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace demo
+{
+	namespace
+	{
+		constexpr U32 kMaxThreads = 64;
+		constexpr U32 kZonesPerThread = 16 << 10; // Power of two
+		constexpr U32 kReadMargin = 256; // Oldest zones may be overwritten while reading
+		constexpr U32 kMaxFrameTimes = 240;
+
+		struct ThreadBuffer
+		{
+			ProfilerZone zones[kZonesPerThread];
+			std::atomic<U32> head; // Written only by the owning thread
+			char name[32];
+		};
+
+		std::atomic<ThreadBuffer*> s_threads[kMaxThreads]; // NULL until the thread that took the index stores it
+		std::atomic<bool> s_isUsed[kMaxThreads]; // Buffers of exited threads are taken over by new ones
+		std::atomic<U32> s_numThreads(0);
+
+		thread_local ThreadBuffer* t_buffer = NULL;
+		thread_local U16 t_thread = 0;
+		thread_local U16 t_depth = 0;
+
+		// Hands the buffer back when its thread exits, worker threads restarted on every reload would
+		// otherwise use up all kMaxThreads buffers
+		struct ThreadSlot
+		{
+			~ThreadSlot()
+			{
+				if (NULL != t_buffer)
+				{
+					s_isUsed[t_thread].store(false, std::memory_order_release);
+				}
+			}
+		};
+
+		thread_local ThreadSlot t_slot;
+
+		// Main thread only
+		U16 s_mainThread = 0;
+		I64 s_frameBegin = 0;
+		I64 s_lastFrameBegin = 0;
+		F64 s_frameTimes[kMaxFrameTimes];
+		U32 s_numFrameTimes = 0;
+		U32 s_frameTimeHead = 0;
+
+		U32 getNumThreads()
+		{
+			return base::min<U32>(s_numThreads, kMaxThreads);
+		}
+
+		ThreadBuffer* getThreadBuffer()
+		{
+			if (NULL == t_buffer)
+			{
+				// Binding it constructs the slot, so it is destroyed with the thread
+				ThreadSlot& slot = t_slot;
+				BASE_UNUSED(slot);
+
+				// Zones an exited thread left in a buffer show under the name of the thread taking it over
+				const U32 numThreads = getNumThreads();
+				for (U32 i = 0; i < numThreads; i++)
+				{
+					ThreadBuffer* buffer = s_threads[i].load(std::memory_order_acquire);
+					bool isUsed = false;
+					if (NULL != buffer && s_isUsed[i].compare_exchange_strong(isUsed, true, std::memory_order_acquire))
+					{
+						base::snprintf(buffer->name, sizeof(buffer->name), "Thread %d", i);
+						t_buffer = buffer;
+						t_thread = (U16)i;
+						return t_buffer;
+					}
+				}
+
+				const U32 index = s_numThreads++;
+				if (index >= kMaxThreads)
+				{
+					return NULL;
+				}
+
+				ThreadBuffer* buffer = new ThreadBuffer();
+				buffer->head = 0;
+				base::snprintf(buffer->name, sizeof(buffer->name), "Thread %d", index);
+				s_isUsed[index].store(true, std::memory_order_relaxed);
+				s_threads[index].store(buffer, std::memory_order_release);
+
+				t_buffer = buffer;
+				t_thread = (U16)index;
+			}
+
+			return t_buffer;
+		}
+
+		// Copies out the zones that are safe to read, oldest first.
+		void readZones(std::vector<ProfilerZone>& _out, const ThreadBuffer& _buffer)
+		{
+			const U32 head = _buffer.head.load(std::memory_order_acquire);
+			const U32 num = base::min<U32>(head, kZonesPerThread - kReadMargin);
+			for (U32 i = head - num; i != head; i++)
+			{
+				_out.push_back(_buffer.zones[i & (kZonesPerThread - 1)]);
+			}
+		}
+
+		void writeEscaped(base::FileWriter& _writer, const char* _string, base::Error* _err)
+		{
+			for (const char* c = _string; *c != '\0'; c++)
+			{
+				if (*c == '"' || *c == '\\')
+				{
+					base::write(&_writer, "\\", 1, _err);
+				}
+				base::write(&_writer, c, 1, _err);
+			}
+		}
+
+	} // namespace
+
+	void profilerSetThreadName(const char* _name)
+	{
+		ThreadBuffer* buffer = getThreadBuffer();
+		if (NULL != buffer)
+		{
+			base::snprintf(buffer->name, sizeof(buffer->name), "%s", _name);
+		}
+	}
+
+	void profilerBeginFrame()
+	{
+		if (NULL == getThreadBuffer())
+		{
+			return;
+		}
+		s_mainThread = t_thread;
+
+		const I64 now = base::getHPCounter();
+		if (s_frameBegin != 0)
+		{
+			s_frameTimes[s_frameTimeHead] = F64(now - s_frameBegin) * 1000.0 / F64(base::getHPFrequency());
+			s_frameTimeHead = (s_frameTimeHead + 1) % kMaxFrameTimes;
+			s_numFrameTimes = base::min(s_numFrameTimes + 1, kMaxFrameTimes);
+		}
+
+		s_lastFrameBegin = s_frameBegin;
+		s_frameBegin = now;
+	}
+
+	void profilerShutdown()
+	{
+		const U32 numThreads = getNumThreads();
+		for (U32 i = 0; i < numThreads; i++)
+		{
+			delete s_threads[i].exchange(NULL);
+			s_isUsed[i] = false;
+		}
+
+		s_numThreads = 0;
+		t_buffer = NULL;
+	}
+
+	U32 profilerGetLastFrame(ProfilerZone* _zones, U32 _maxZones, I64* _outFrameBegin, I64* _outFrameEnd)
+	{
+		*_outFrameBegin = s_lastFrameBegin;
+		*_outFrameEnd = s_frameBegin;
+		const ThreadBuffer* mainBuffer = s_mainThread < getNumThreads() ? s_threads[s_mainThread].load(std::memory_order_acquire) : NULL;
+		if (s_lastFrameBegin == 0 || NULL == mainBuffer)
+		{
+			return 0;
+		}
+
+		// Zones are stored in the order they end, walk back until before the last frame
+		const ThreadBuffer& buffer = *mainBuffer;
+		const U32 head = buffer.head.load(std::memory_order_acquire);
+		const U32 maxBack = base::min<U32>(head, kZonesPerThread - kReadMargin);
+
+		U32 num = 0;
+		for (U32 i = 0; i < maxBack && num < _maxZones; i++)
+		{
+			const ProfilerZone& zone = buffer.zones[(head - 1 - i) & (kZonesPerThread - 1)];
+			if (zone.end <= s_lastFrameBegin)
+			{
+				break;
+			}
+
+			if (zone.begin >= s_lastFrameBegin && zone.end <= s_frameBegin)
+			{
+				_zones[num++] = zone;
+			}
+		}
+
+		std::sort(_zones, _zones + num, [](const ProfilerZone& _a, const ProfilerZone& _b)
+			{
+				return _a.begin < _b.begin || (_a.begin == _b.begin && _a.depth < _b.depth);
+			});
+
+		return num;
+	}
+
+	F64 profilerGetFrameTimeMs(U32 _framesAgo)
+	{
+		if (_framesAgo >= s_numFrameTimes)
+		{
+			return 0.0;
+		}
+
+		return s_frameTimes[(s_frameTimeHead + kMaxFrameTimes - 1 - _framesAgo) % kMaxFrameTimes];
+	}
+
+	U32 profilerGetNumFrameTimes()
+	{
+		return s_numFrameTimes;
+	}
+
+	bool profilerExportChromeTrace(const base::FilePath& _filePath)
+	{
+		base::FileWriter writer;
+		base::Error err;
+		if (!base::open(&writer, _filePath, false, &err))
+		{
+			BASE_TRACE("Failed: Opening %s for writing", _filePath.getCPtr())
+			return false;
+		}
+
+		const F64 toUs = 1000000.0 / F64(base::getHPFrequency());
+		I64 start = INT64_MAX;
+
+		// Threads still creating their buffer are left out
+		std::vector<const ThreadBuffer*> buffers(getNumThreads());
+		std::vector<std::vector<ProfilerZone> > zones(buffers.size());
+		for (U32 i = 0; i < zones.size(); i++)
+		{
+			buffers[i] = s_threads[i].load(std::memory_order_acquire);
+			if (NULL == buffers[i])
+			{
+				continue;
+			}
+
+			readZones(zones[i], *buffers[i]);
+			for (const ProfilerZone& zone : zones[i])
+			{
+				start = base::min(start, zone.begin);
+			}
+		}
+
+		char line[256];
+		base::write(&writer, "{\"traceEvents\":[\n", 17, &err);
+
+		bool isFirst = true;
+		for (U32 i = 0; i < zones.size(); i++)
+		{
+			if (NULL == buffers[i])
+			{
+				continue;
+			}
+
+			// Thread name metadata
+			I32 len = base::snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"",
+				isFirst ? "" : ",\n", i);
+			base::write(&writer, line, len, &err);
+			writeEscaped(writer, buffers[i]->name, &err);
+			base::write(&writer, "\"}}", 3, &err);
+			isFirst = false;
+
+			for (const ProfilerZone& zone : zones[i])
+			{
+				base::write(&writer, ",\n{\"name\":\"", 11, &err);
+				writeEscaped(writer, zone.name, &err);
+				len = base::snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+					i, F64(zone.begin - start) * toUs, F64(zone.end - zone.begin) * toUs);
+				base::write(&writer, line, len, &err);
+			}
+		}
+
+		base::write(&writer, "\n]}\n", 4, &err);
+		base::close(&writer);
+
+		BASE_TRACE("Exported profiler capture to %s", _filePath.getCPtr())
+		return err.isOk();
+	}
+
+	U16 profilerPushZone()
+	{
+		return t_depth++;
+	}
+
+	void profilerPopZone(const char* _name, I64 _begin, U16 _depth)
+	{
+		const I64 end = base::getHPCounter();
+		t_depth = _depth;
+
+		ThreadBuffer* buffer = getThreadBuffer();
+		if (NULL == buffer)
+		{
+			return;
+		}
+
+		const U32 head = buffer->head.load(std::memory_order_relaxed);
+		ProfilerZone& zone = buffer->zones[head & (kZonesPerThread - 1)];
+		zone.name = _name;
+		zone.begin = _begin;
+		zone.end = end;
+		zone.thread = t_thread;
+		zone.depth = _depth;
+		buffer->head.store(head + 1, std::memory_order_release);
+	}
+
+} // namespace demo
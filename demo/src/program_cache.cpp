@@ -0,0 +1,129 @@
+#include "program_cache.h"
+#include "profiler.h"
+
+namespace demo
+{
+	ProgramCache::ProgramCache()
+		: m_reader(NULL)
+		, m_initTime(0)
+		, m_warmTimeMs(0.0)
+	{}
+
+	ProgramCache::~ProgramCache()
+	{
+		shutdown();
+	}
+
+	bool ProgramCache::init(PakxReader* _reader)
+	{
+		shutdown();
+
+		m_reader = _reader;
+		m_initTime = base::getHPCounter();
+		m_thread = std::thread(&ProgramCache::readProgramTable, this);
+
+		return true;
+	}
+
+	void ProgramCache::warm()
+	{
+		DEMO_PROFILER_SCOPE("ProgramCache::warm");
+
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+
+		m_shaderHandles.resize(m_shaders.size());
+		for (U32 i = 0; i < m_shaders.size(); i++)
+		{
+			m_shaderHandles[i] = GRAPHICS_INVALID_HANDLE;
+			if (!m_bytecode[i].empty())
+			{
+				m_shaderHandles[i] = graphics::createShader(graphics::copy(m_bytecode[i].data(), (U32)m_bytecode[i].size()));
+			}
+		}
+
+		m_programHandles.resize(m_programs.size());
+		for (U32 i = 0; i < m_programs.size(); i++)
+		{
+			const graphics::ShaderHandle vsh = m_shaderHandles[m_programs[i].vertexShader];
+			const graphics::ShaderHandle fsh = m_shaderHandles[m_programs[i].fragmentShader];
+			m_programHandles[i] = GRAPHICS_INVALID_HANDLE;
+			if (graphics::isValid(vsh) && graphics::isValid(fsh))
+			{
+				m_programHandles[i] = graphics::createProgram(vsh, fsh);
+			}
+		}
+
+		// Bytecode is owned by the renderer now
+		m_bytecode.clear();
+		m_bytecode.shrink_to_fit();
+
+		m_warmTimeMs = F64(base::getHPCounter() - m_initTime) * 1000.0 / F64(base::getHPFrequency());
+		BASE_TRACE("Warmed %d programs from %d shaders in %.1f ms", (U32)m_programHandles.size(), (U32)m_shaderHandles.size(), m_warmTimeMs)
+	}
+
+	void ProgramCache::shutdown()
+	{
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+
+		// Materials keep their own references, this only drops ours
+		for (graphics::ProgramHandle program : m_programHandles)
+		{
+			if (graphics::isValid(program))
+			{
+				graphics::destroy(program);
+			}
+		}
+
+		for (graphics::ShaderHandle shader : m_shaderHandles)
+		{
+			if (graphics::isValid(shader))
+			{
+				graphics::destroy(shader);
+			}
+		}
+
+		m_shaders.clear();
+		m_programs.clear();
+		m_bytecode.clear();
+		m_shaderHandles.clear();
+		m_programHandles.clear();
+		m_reader = NULL;
+	}
+
+	void ProgramCache::readProgramTable()
+	{
+		profilerSetThreadName("Program Cache");
+		DEMO_PROFILER_SCOPE("ProgramCache::readProgramTable");
+
+		pakx::ProgramsHeader header;
+		if (!m_reader->read(pakx::kChunkPrograms, 0, &header, sizeof(header)))
+		{
+			return;
+		}
+
+		m_shaders.resize(header.numShaders);
+		m_programs.resize(header.numPrograms);
+
+		U32 offset = sizeof(pakx::ProgramsHeader);
+		m_reader->read(pakx::kChunkPrograms, offset, m_shaders.data(), (U32)(m_shaders.size() * sizeof(pakx::ProgramShader)));
+		offset += (U32)(m_shaders.size() * sizeof(pakx::ProgramShader));
+		m_reader->read(pakx::kChunkPrograms, offset, m_programs.data(), (U32)(m_programs.size() * sizeof(pakx::Program)));
+
+		m_bytecode.resize(m_shaders.size());
+		for (U32 i = 0; i < m_shaders.size(); i++)
+		{
+			m_bytecode[i].resize(m_shaders[i].size);
+			if (!m_reader->read(pakx::kChunkPrograms, m_shaders[i].offset, m_bytecode[i].data(), m_shaders[i].size))
+			{
+				m_bytecode[i].clear();
+			}
+		}
+	}
+
+} // namespace demo
@@ -0,0 +1,195 @@
+#include "resource_stats.h"
+#include "profiler.h"
+
+// std
+#include <algorithm>
+
+namespace demo
+{
+	namespace
+	{
+		// Resources created at runtime aren't in the .pakx but are reported by the engine too
+		constexpr U32 kMinInfos = 256;
+
+		constexpr const char* kTypeNames[] =
+		{
+			"Geometry",
+			"Texture",
+			"Material",
+			"Shader",
+			"Mesh",
+			"Prefab",
+			"Other",
+		};
+		static_assert(BASE_COUNTOF(kTypeNames) == pakx::ResourceType::Count + 1, "Missing resource type name");
+
+	} // namespace
+
+	ResourceStats::ResourceStats()
+		: m_initTime(0)
+		, m_frame(0)
+	{
+		base::memSet(m_totals, 0, sizeof(m_totals));
+	}
+
+	void ResourceStats::init(PakxReader* _reader)
+	{
+		shutdown();
+		m_initTime = base::getHPCounter();
+
+		pakx::ResourcesHeader header;
+		if (NULL != _reader && _reader->read(pakx::kChunkResources, 0, &header, sizeof(header)))
+		{
+			std::vector<pakx::Resource> resources(header.numResources);
+			_reader->read(pakx::kChunkResources, sizeof(header), resources.data(), (U32)(resources.size() * sizeof(pakx::Resource)));
+			for (const pakx::Resource& resource : resources)
+			{
+				m_sizes[resource.vfpHash] = resource;
+			}
+		}
+
+		// Starting size only, update grows the buffer when the engine reports more resources
+		m_infos.resize(base::max<U32>((U32)m_sizes.size() * 2, kMinInfos));
+	}
+
+	void ResourceStats::shutdown()
+	{
+		m_sizes.clear();
+		m_entryLookup.clear();
+		m_entries.clear();
+		m_order.clear();
+		m_infos.clear();
+		m_frame = 0;
+	}
+
+	void ResourceStats::setBudget(pakx::ResourceType::Enum _type, U64 _bytes)
+	{
+		m_totals[_type].budgetBytes = _bytes;
+	}
+
+	void ResourceStats::update()
+	{
+		DEMO_PROFILER_SCOPE("ResourceStats::update");
+
+		m_frame++;
+		for (Entry& entry : m_entries)
+		{
+			entry.isLoaded = false;
+			entry.refCount = 0;
+		}
+
+		const F64 nowMs = F64(base::getHPCounter() - m_initTime) * 1000.0 / F64(base::getHPFrequency());
+		// The engine writes every resource without a capacity, a NULL buffer only returns the count
+		const U32 numResources = mara::getResourceInfo(NULL, true);
+		if (numResources > m_infos.size())
+		{
+			m_infos.resize(base::max<U32>(numResources * 2, kMinInfos));
+		}
+		const U32 num = base::min<U32>(mara::getResourceInfo(m_infos.data(), true), (U32)m_infos.size());
+		for (U32 i = 0; i < num; i++)
+		{
+			const mara::ResourceInfo& info = m_infos[i];
+			const U32 hash = pakx::hashVfp(info.vfp.getCPtr());
+
+			auto it = m_entryLookup.find(hash);
+			if (it == m_entryLookup.end())
+			{
+				Entry entry;
+				entry.vfp = info.vfp;
+				entry.vfpHash = hash;
+				entry.type = pakx::ResourceType::Count;
+				entry.cpuBytes = 0;
+				entry.gpuBytes = 0;
+				entry.firstSeenMs = nowMs;
+				entry.lastUsedFrame = 0;
+
+				auto size = m_sizes.find(hash);
+				if (size != m_sizes.end())
+				{
+					entry.type = (pakx::ResourceType::Enum)base::min<U8>(size->second.type, pakx::ResourceType::Count);
+					entry.cpuBytes = size->second.cpuBytes;
+					entry.gpuBytes = size->second.gpuBytes;
+				}
+
+				it = m_entryLookup.emplace(hash, (U32)m_entries.size()).first;
+				m_entries.push_back(entry);
+				m_order.push_back(it->second);
+			}
+
+			Entry& entry = m_entries[it->second];
+			if (entry.firstSeenMs < 0.0)
+			{
+				entry.firstSeenMs = nowMs;
+			}
+			entry.isLoaded = true;
+			entry.refCount = info.refCount;
+			if (info.refCount > 0)
+			{
+				entry.lastUsedFrame = m_frame;
+			}
+		}
+
+		for (U32 i = 0; i < pakx::ResourceType::Count + 1; i++)
+		{
+			m_totals[i].numResources = 0;
+			m_totals[i].cpuBytes = 0;
+			m_totals[i].gpuBytes = 0;
+		}
+		for (Entry& entry : m_entries)
+		{
+			// Unloaded resources are first seen again the next time they are loaded
+			if (!entry.isLoaded)
+			{
+				entry.firstSeenMs = -1.0;
+				continue;
+			}
+
+			Totals& totals = m_totals[entry.type];
+			totals.numResources++;
+			totals.cpuBytes += entry.cpuBytes;
+			totals.gpuBytes += entry.gpuBytes;
+		}
+
+		// Largest first, ties keep the order resources were first seen in
+		std::stable_sort(m_order.begin(), m_order.end(), [this](U32 _a, U32 _b)
+			{
+				const Entry& a = m_entries[_a];
+				const Entry& b = m_entries[_b];
+				return U64(a.cpuBytes) + a.gpuBytes > U64(b.cpuBytes) + b.gpuBytes;
+			});
+	}
+
+	bool ResourceStats::exportCsv(const base::FilePath& _filePath) const
+	{
+		base::FileWriter writer;
+		base::Error err;
+		if (!base::open(&writer, _filePath, false, &err))
+		{
+			BASE_TRACE("Failed: Opening %s for writing", _filePath.getCPtr())
+			return false;
+		}
+
+		char line[1024];
+		I32 len = base::snprintf(line, sizeof(line), "vfp,type,loaded,ref_count,cpu_bytes,gpu_bytes,first_seen_ms,last_used_frame\n");
+		base::write(&writer, line, len, &err);
+
+		for (U32 index : m_order)
+		{
+			const Entry& entry = m_entries[index];
+			len = base::snprintf(line, sizeof(line), "\"%s\",%s,%d,%d,%u,%u,%.3f,%u\n", entry.vfp.getCPtr(), getTypeName(entry.type),
+				entry.isLoaded ? 1 : 0, entry.refCount, entry.cpuBytes, entry.gpuBytes, entry.firstSeenMs, entry.lastUsedFrame);
+			base::write(&writer, line, base::min<I32>(len, sizeof(line) - 1), &err);
+		}
+
+		base::close(&writer);
+
+		BASE_TRACE("Exported resource stats to %s", _filePath.getCPtr())
+		return err.isOk();
+	}
+
+	const char* ResourceStats::getTypeName(pakx::ResourceType::Enum _type)
+	{
+		return kTypeNames[base::min<U32>(_type, pakx::ResourceType::Count)];
+	}
+
+} // namespace demo
@@ -0,0 +1,254 @@
+#include "resource_table.h"
+#include "profiler.h"
+
+namespace demo
+{
+	namespace
+	{
+		// Generation 0 is never handed out so a zeroed handle is stale, 0xffff would look invalid
+		constexpr U32 kFirstGeneration = 1;
+		constexpr U32 kMaxGenerations = 0xffff;
+
+		U64 makeState(U32 _generation, U32 _refCount)
+		{
+			return (U64(_generation) << 32) | _refCount;
+		}
+
+	} // namespace
+
+	ResourceTable::Slot::Slot()
+		: state(makeState(kFirstGeneration, 0))
+		, data(NULL)
+		, vfpHash(0)
+	{}
+
+	ResourceTable::ResourceTable()
+		: m_slots(NULL)
+		, m_maxResources(0)
+		, m_destroy(NULL)
+		, m_numResources(0)
+	{}
+
+	ResourceTable::~ResourceTable()
+	{
+		shutdown();
+	}
+
+	bool ResourceTable::init(U32 _maxResources, DestroyFn _destroy)
+	{
+		shutdown();
+
+		m_maxResources = base::min<U32>(_maxResources, 0xffff);
+		m_destroy = _destroy;
+		m_slots = new Slot[m_maxResources];
+
+		// Lowest slots are handed out first
+		m_free.reserve(m_maxResources);
+		for (U32 i = m_maxResources; i > 0; i--)
+		{
+			m_free.push_back(U16(i - 1));
+		}
+
+		return true;
+	}
+
+	void ResourceTable::shutdown()
+	{
+		if (NULL == m_slots)
+		{
+			return;
+		}
+
+		// Everything still registered goes, referenced or not
+		for (U32 i = 0; i < m_maxResources; i++)
+		{
+			if (NULL != m_slots[i].data)
+			{
+				m_destroy(m_slots[i].data);
+			}
+		}
+		for (void* data : m_replaced)
+		{
+			m_destroy(data);
+		}
+
+		delete[] m_slots;
+		m_slots = NULL;
+		m_maxResources = 0;
+		m_lookup.clear();
+		m_free.clear();
+		m_pending.clear();
+		m_replaced.clear();
+		m_numResources = 0;
+	}
+
+	ResourceRef ResourceTable::find(U32 _vfpHash)
+	{
+		// Generation is read while the lookup still holds, collect can only move it on afterwards
+		ResourceRef ref;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_lookup.find(_vfpHash);
+			if (it == m_lookup.end())
+			{
+				return kInvalidResourceRef;
+			}
+			ref.value = (U32(m_slots[it->second].state.load(std::memory_order_acquire) >> 32) << 16) | it->second;
+		}
+
+		return acquire(ref) ? ref : kInvalidResourceRef;
+	}
+
+	ResourceRef ResourceTable::insert(U32 _vfpHash, void* _data)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Lost a race against another loader, or the path is waiting to be destroyed
+		auto it = m_lookup.find(_vfpHash);
+		if (it != m_lookup.end())
+		{
+			const ResourceRef ref = { (U32(m_slots[it->second].state.load(std::memory_order_acquire) >> 32) << 16) | it->second };
+			if (acquire(ref))
+			{
+				return ref;
+			}
+		}
+
+		if (m_free.empty())
+		{
+			BASE_TRACE("Failed: Resource table is full, %d resources", m_maxResources)
+			return kInvalidResourceRef;
+		}
+
+		const U16 index = m_free.back();
+		m_free.pop_back();
+
+		// Data is written before the release store that makes the slot visible to get
+		Slot& slot = m_slots[index];
+		slot.data.store(_data, std::memory_order_relaxed);
+		slot.vfpHash = _vfpHash;
+		const U32 generation = U32(slot.state.load(std::memory_order_relaxed) >> 32);
+		slot.state.store(makeState(generation, 1), std::memory_order_release);
+
+		m_lookup[_vfpHash] = index;
+		m_numResources++;
+
+		const ResourceRef ref = { (generation << 16) | index };
+		return ref;
+	}
+
+	bool ResourceTable::replace(ResourceRef _ref, void* _data)
+	{
+		if (!isValid(_ref) || (_ref.value & 0xffff) >= m_maxResources)
+		{
+			return false;
+		}
+
+		// Under the lock collect can't move the slot to its next generation in between
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		Slot& slot = m_slots[_ref.value & 0xffff];
+		if ((slot.state.load(std::memory_order_acquire) >> 32) != (_ref.value >> 16) || NULL == slot.data)
+		{
+			return false;
+		}
+
+		m_replaced.push_back(slot.data.exchange(_data, std::memory_order_acq_rel));
+		return true;
+	}
+
+	bool ResourceTable::acquire(ResourceRef _ref)
+	{
+		if (!isValid(_ref) || (_ref.value & 0xffff) >= m_maxResources)
+		{
+			return false;
+		}
+
+		// A resource waiting for collect can be picked up again, its generation is still the same
+		Slot& slot = m_slots[_ref.value & 0xffff];
+		U64 state = slot.state.load(std::memory_order_relaxed);
+		do
+		{
+			if ((state >> 32) != (_ref.value >> 16))
+			{
+				return false;
+			}
+		} while (!slot.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+		return true;
+	}
+
+	void ResourceTable::release(ResourceRef _ref)
+	{
+		if (!isValid(_ref) || (_ref.value & 0xffff) >= m_maxResources)
+		{
+			return;
+		}
+
+		const U16 index = U16(_ref.value & 0xffff);
+		const U64 previous = m_slots[index].state.fetch_sub(1, std::memory_order_acq_rel);
+		if ((previous & 0xffffffff) == 1)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending.push_back(index);
+		}
+	}
+
+	void ResourceTable::collect()
+	{
+		std::vector<U16> pending;
+		std::vector<void*> replaced;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			pending.swap(m_pending);
+			replaced.swap(m_replaced);
+		}
+
+		if (pending.empty() && replaced.empty())
+		{
+			return;
+		}
+
+		DEMO_PROFILER_SCOPE("ResourceTable::collect");
+
+		for (void* data : replaced)
+		{
+			m_destroy(data);
+		}
+
+		for (U16 index : pending)
+		{
+			void* data = NULL;
+			{
+				// Moving to the next generation fails if the resource was acquired again in the meantime. The
+				// lookup goes in the same step so find never hands out the new generation.
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				Slot& slot = m_slots[index];
+				U64 state = slot.state.load(std::memory_order_acquire);
+				const U32 generation = U32(state >> 32);
+				const U32 nextGeneration = generation + 1 < kMaxGenerations ? generation + 1 : kFirstGeneration;
+				if ((state & 0xffffffff) != 0 || NULL == slot.data
+					|| !slot.state.compare_exchange_strong(state, makeState(nextGeneration, 0), std::memory_order_acq_rel))
+				{
+					continue;
+				}
+
+				data = slot.data;
+				m_lookup.erase(slot.vfpHash);
+				slot.data.store(NULL, std::memory_order_relaxed);
+				m_free.push_back(index);
+				m_numResources--;
+			}
+
+			m_destroy(data);
+		}
+	}
+
+	U32 ResourceTable::getNumPending() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return (U32)m_pending.size();
+	}
+
+} // namespace demo
@@ -0,0 +1,76 @@
+#include "texture_arrays.h"
+#include "profiler.h"
+
+namespace demo
+{
+	TextureArrays::TextureArrays()
+		: m_memoryBytes(0)
+	{}
+
+	TextureArrays::~TextureArrays()
+	{
+		shutdown();
+	}
+
+	bool TextureArrays::init(PakxReader* _reader)
+	{
+		DEMO_PROFILER_SCOPE("TextureArrays::init");
+
+		shutdown();
+
+		pakx::TextureArraysHeader header;
+		if (!_reader->read(pakx::kChunkTextureArrays, 0, &header, sizeof(header)))
+		{
+			return false;
+		}
+
+		std::vector<pakx::TextureArray> arrays(header.numArrays);
+		_reader->read(pakx::kChunkTextureArrays, sizeof(header), arrays.data(), (U32)(arrays.size() * sizeof(pakx::TextureArray)));
+
+		const U16 maxLayers = graphics::getCaps()->limits.maxTextureLayers;
+		for (const pakx::TextureArray& array : arrays)
+		{
+			graphics::TextureHandle handle = GRAPHICS_INVALID_HANDLE;
+
+			// Data is laid out layer by layer with all mips, as the renderer expects it
+			std::vector<U8> data(array.size);
+			if (array.numLayers <= maxLayers && _reader->read(pakx::kChunkTextureArrays, array.offset, data.data(), array.size))
+			{
+				handle = graphics::createTexture2D(array.width, array.height, array.numMips > 1, array.numLayers,
+					graphics::TextureFormat::RGBA8, 0, graphics::copy(data.data(), array.size));
+				m_memoryBytes += array.size;
+			}
+			else
+			{
+				BASE_TRACE("Failed: Texture array %dx%d with %d layers", array.width, array.height, array.numLayers)
+			}
+
+			m_handles.push_back(handle);
+		}
+
+		return true;
+	}
+
+	void TextureArrays::shutdown()
+	{
+		for (graphics::TextureHandle handle : m_handles)
+		{
+			if (graphics::isValid(handle))
+			{
+				graphics::destroy(handle);
+			}
+		}
+
+		m_handles.clear();
+		m_memoryBytes = 0;
+	}
+
+	void TextureArrays::bind(U8 _stage, graphics::UniformHandle _sampler, U32 _array) const
+	{
+		if (_array < m_handles.size() && graphics::isValid(m_handles[_array]))
+		{
+			graphics::setTexture(_stage, _sampler, m_handles[_array]);
+		}
+	}
+
+} // namespace demo
@@ -0,0 +1,312 @@
+#include "texture_streamer.h"
+#include "profiler.h"
+
+namespace demo
+{
+	namespace
+	{
+		constexpr U8 kNoPendingMip = 0xFF;
+		constexpr U64 kMaxUploadBytesPerFrame = 8 << 20;
+
+		U16 getMipSize(U16 _size, U8 _mip)
+		{
+			return (U16)base::max<U32>(_size >> _mip, 1);
+		}
+
+	} // namespace
+
+	TextureStreamer::TextureStreamer()
+		: m_reader(NULL)
+		, m_frame(0)
+		, m_pendingBytes(0)
+		, m_quit(false)
+	{
+		base::memSet(&m_stats, 0, sizeof(m_stats));
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		shutdown();
+	}
+
+	bool TextureStreamer::init(PakxReader* _reader, U64 _budgetBytes)
+	{
+		m_reader = _reader;
+		m_stats.budgetBytes = _budgetBytes;
+
+		pakx::TexturesHeader header;
+		if (!m_reader->read(pakx::kChunkTextures, 0, &header, sizeof(header)))
+		{
+			return false;
+		}
+
+		std::vector<pakx::StreamTexture> infos(header.numTextures);
+		m_reader->read(pakx::kChunkTextures, sizeof(header), infos.data(), (U32)(infos.size() * sizeof(pakx::StreamTexture)));
+
+		// Load mip tails up front so everything is drawable right away
+		m_textures.resize(header.numTextures);
+		for (U32 i = 0; i < header.numTextures; i++)
+		{
+			Texture& texture = m_textures[i];
+			texture.info = infos[i];
+			texture.handle = GRAPHICS_INVALID_HANDLE;
+			texture.residentMip = texture.info.numMips;
+			texture.wantedMip = texture.info.tailMip;
+			texture.pendingMip = kNoPendingMip;
+			texture.lastUsedFrame = 0;
+
+			const U8 tailMip = texture.info.tailMip;
+			const U32 tailOffset = texture.info.mipOffset[tailMip];
+			const U64 tailSize = getMipChainSize(texture, tailMip);
+			texture.tail.resize((size_t)tailSize);
+			m_reader->read(pakx::kChunkTextures, tailOffset, texture.tail.data(), (U32)tailSize);
+
+			recreate(texture, tailMip, NULL);
+		}
+		m_stats.numTextures = header.numTextures;
+
+		m_quit = false;
+		m_thread = std::thread(&TextureStreamer::worker, this);
+		return true;
+	}
+
+	void TextureStreamer::shutdown()
+	{
+		if (m_thread.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_quit = true;
+			}
+			m_cv.notify_one();
+			m_thread.join();
+		}
+
+		for (Texture& texture : m_textures)
+		{
+			if (graphics::isValid(texture.handle))
+			{
+				graphics::destroy(texture.handle);
+			}
+		}
+		m_textures.clear();
+		m_requests.clear();
+		m_finished.clear();
+		m_pendingBytes = 0;
+
+		// Worker is joined, reads it still had queued are never finished
+		base::memSet(&m_stats, 0, sizeof(m_stats));
+	}
+
+	void TextureStreamer::request(U32 _texture, F32 _screenSize)
+	{
+		Texture& texture = m_textures[_texture];
+		texture.lastUsedFrame = m_frame;
+
+		// One texel per pixel, the texture is assumed to span the object once
+		const F32 texels = (F32)base::max(texture.info.width, texture.info.height);
+		const F32 ratio = texels / base::max(_screenSize, 1.0f);
+		const U8 mip = (U8)base::clamp<F32>(base::floor(base::log2(ratio)), 0.0f, (F32)texture.info.tailMip);
+
+		texture.wantedMip = base::min(texture.wantedMip, mip);
+	}
+
+	void TextureStreamer::bind(U8 _stage, graphics::UniformHandle _sampler, U32 _texture) const
+	{
+		graphics::setTexture(_stage, _sampler, m_textures[_texture].handle);
+	}
+
+	void TextureStreamer::update()
+	{
+		DEMO_PROFILER_SCOPE("TextureStreamer::update");
+
+		applyReads();
+		issueReads();
+
+		// Wanted mips are gathered again next frame
+		for (Texture& texture : m_textures)
+		{
+			texture.wantedMip = texture.info.tailMip;
+		}
+
+		m_frame++;
+	}
+
+	U64 TextureStreamer::getMipChainSize(const Texture& _texture, U8 _mip) const
+	{
+		U64 size = 0;
+		for (U8 i = _mip; i < _texture.info.numMips; i++)
+		{
+			size += _texture.info.mipSize[i];
+		}
+		return size;
+	}
+
+	void TextureStreamer::recreate(Texture& _texture, U8 _mip, const U8* _data)
+	{
+		const pakx::StreamTexture& info = _texture.info;
+
+		graphics::TextureHandle handle = graphics::createTexture2D(
+			getMipSize(info.width, _mip), getMipSize(info.height, _mip), true, 1, graphics::TextureFormat::RGBA8);
+
+		// Mips above the tail come from the read, the tail from memory
+		for (U8 i = _mip; i < info.numMips; i++)
+		{
+			const U8* src = (i < info.tailMip)
+				? _data + (info.mipOffset[i] - info.mipOffset[_mip])
+				: _texture.tail.data() + (info.mipOffset[i] - info.mipOffset[info.tailMip]);
+
+			graphics::updateTexture2D(handle, 0, i - _mip, 0, 0,
+				getMipSize(info.width, i), getMipSize(info.height, i), graphics::copy(src, info.mipSize[i]));
+		}
+
+		if (graphics::isValid(_texture.handle))
+		{
+			graphics::destroy(_texture.handle);
+			m_stats.residentBytes -= getMipChainSize(_texture, _texture.residentMip);
+		}
+
+		_texture.handle = handle;
+		_texture.residentMip = _mip;
+		m_stats.residentBytes += getMipChainSize(_texture, _mip);
+	}
+
+	bool TextureStreamer::makeRoom(U64 _bytes)
+	{
+		while (m_stats.residentBytes + m_pendingBytes + _bytes > m_stats.budgetBytes)
+		{
+			// Least recently used texture that is above its tail and not in use this frame
+			Texture* victim = NULL;
+			for (Texture& texture : m_textures)
+			{
+				if (texture.residentMip < texture.info.tailMip &&
+					texture.pendingMip == kNoPendingMip &&
+					texture.lastUsedFrame < m_frame &&
+					(NULL == victim || texture.lastUsedFrame < victim->lastUsedFrame))
+				{
+					victim = &texture;
+				}
+			}
+
+			if (NULL == victim)
+			{
+				return false;
+			}
+
+			recreate(*victim, victim->info.tailMip, NULL);
+			m_stats.numEvictions++;
+		}
+
+		return true;
+	}
+
+	void TextureStreamer::issueReads()
+	{
+		for (U32 i = 0; i < m_textures.size(); i++)
+		{
+			Texture& texture = m_textures[i];
+			if (texture.pendingMip != kNoPendingMip || texture.wantedMip >= texture.residentMip)
+			{
+				continue;
+			}
+
+			// Step down in detail until the request fits the budget
+			U8 mip = texture.wantedMip;
+			while (mip < texture.residentMip)
+			{
+				const U64 extra = getMipChainSize(texture, mip) - getMipChainSize(texture, texture.residentMip);
+				if (makeRoom(extra))
+				{
+					break;
+				}
+				mip++;
+			}
+			if (mip >= texture.residentMip)
+			{
+				continue;
+			}
+
+			Read read;
+			read.texture = i;
+			read.mip = mip;
+
+			texture.pendingMip = mip;
+			m_pendingBytes += getMipChainSize(texture, mip) - getMipChainSize(texture, texture.residentMip);
+			m_stats.numPendingReads++;
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_requests.push_back(read);
+			}
+			m_cv.notify_one();
+		}
+	}
+
+	void TextureStreamer::applyReads()
+	{
+		DEMO_PROFILER_SCOPE("TextureStreamer::applyReads");
+
+		U64 uploaded = 0;
+		while (uploaded < kMaxUploadBytesPerFrame)
+		{
+			Read read;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_finished.empty())
+				{
+					break;
+				}
+				read = std::move(m_finished.front());
+				m_finished.pop_front();
+			}
+
+			Texture& texture = m_textures[read.texture];
+			m_pendingBytes -= getMipChainSize(texture, read.mip) - getMipChainSize(texture, texture.residentMip);
+			m_stats.numPendingReads--;
+
+			texture.pendingMip = kNoPendingMip;
+			if (!read.data.empty())
+			{
+				recreate(texture, read.mip, read.data.data());
+				uploaded += read.data.size();
+				m_stats.numUploads++;
+			}
+		}
+	}
+
+	void TextureStreamer::worker()
+	{
+		profilerSetThreadName("Texture Streamer");
+
+		while (true)
+		{
+			Read read;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_cv.wait(lock, [this] { return m_quit || !m_requests.empty(); });
+				if (m_quit)
+				{
+					return;
+				}
+				read = std::move(m_requests.front());
+				m_requests.pop_front();
+			}
+
+			DEMO_PROFILER_SCOPE("TextureStreamer::readMip");
+
+			const pakx::StreamTexture& info = m_textures[read.texture].info;
+			const U32 offset = info.mipOffset[read.mip];
+			const U32 size = info.mipOffset[info.tailMip] - offset;
+
+			read.data.resize(size);
+			if (!m_reader->read(pakx::kChunkTextures, offset, read.data.data(), size))
+			{
+				read.data.clear();
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_finished.push_back(std::move(read));
+		}
+	}
+
+} // namespace demo
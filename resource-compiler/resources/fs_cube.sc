@@ -2,19 +2,36 @@ $input v_texcoord0
 
 #include "common.sh"
 
+#if TEXTURED
+#	if TEXTURE_ARRAY
+SAMPLER2DARRAY(s_diffuse, 0);
+#	else
 SAMPLER2D(s_diffuse, 0);
-uniform vec4 u_diffuse;
+#	endif
+#endif
+
+// Packed material block, see pakx::MaterialBlock
+uniform vec4 u_material[2];
+#define u_diffuse      u_material[0]
+#define u_alphaCutoff  u_material[1].x
+#define u_textureLayer u_material[1].y
 
 void main()
 {
-	vec4 textureSample = texture2D(s_diffuse, v_texcoord0);
-	
-	if (textureSample.a >= 0.1)
-	{
-		gl_FragColor = textureSample;
-	}
-	else
+#if TEXTURED
+#	if TEXTURE_ARRAY
+	gl_FragColor = texture2DArray(s_diffuse, vec3(v_texcoord0, u_textureLayer));
+#	else
+	gl_FragColor = texture2D(s_diffuse, v_texcoord0);
+#	endif
+#else
+	gl_FragColor = u_diffuse;
+#endif
+
+#if ALPHA_TEST
+	if (gl_FragColor.a < u_alphaCutoff)
 	{
-		gl_FragColor = u_diffuse;
+		discard;
 	}
+#endif
 }
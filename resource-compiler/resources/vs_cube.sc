@@ -1,11 +1,36 @@
 $input a_position, a_texcoord0
+#if INSTANCED
+$input i_data0, i_data1, i_data2, i_data3
+#endif
 $output v_texcoord0
 
 #include "common.sh"
 
+#if MORPH
+// Blend shape deltas summed over all active targets, one texel per vertex
+SAMPLER2D(s_morph, 1);
+uniform vec4 u_morph; // x: vertices with deltas, 0 when no target is active, y: texture width
+#endif
+
 void main()
 {
-	vec4 position = mul(u_modelViewProj, vec4(a_position, 1.0));
+	vec3 localPosition = a_position;
+#if MORPH
+	int vertexId = int(gl_VertexID);
+	if (float(vertexId) < u_morph.x)
+	{
+		// No integer modulo on older GLSL targets
+		int width = int(u_morph.y);
+		localPosition += texelFetch(s_morph, ivec2(vertexId - (vertexId / width) * width, vertexId / width), 0).xyz;
+	}
+#endif
+
+#if INSTANCED
+	mat4 model = mtxFromCols(i_data0, i_data1, i_data2, i_data3);
+	vec4 position = mul(u_viewProj, mul(model, vec4(localPosition, 1.0)));
+#else
+	vec4 position = mul(u_modelViewProj, vec4(localPosition, 1.0));
+#endif
 
 	gl_Position = position;
 	v_texcoord0 = a_texcoord0;
@@ -0,0 +1,341 @@
+#include "build_report.h"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace compiler
+{
+	namespace
+	{
+		std::atomic<U64> s_numAllocations(0);
+
+		constexpr const char* kStageNames[] =
+		{
+			"parse",
+			"triangulate",
+			"weld",
+			"encode",
+			"write",
+		};
+		static_assert(BASE_COUNTOF(kStageNames) == BuildStage::Count, "Missing stage name");
+
+		F64 toMs(I64 _ticks)
+		{
+			return F64(_ticks) * 1000.0 / F64(base::getHPFrequency());
+		}
+
+		void writeText(base::FileWriter& _writer, const char* _text, base::Error* _err)
+		{
+			U32 len = 0;
+			while (_text[len] != '\0') len++;
+			base::write(&_writer, _text, (I32)len, _err);
+		}
+
+		void writeString(base::FileWriter& _writer, const char* _string, base::Error* _err)
+		{
+			base::write(&_writer, "\"", 1, _err);
+			for (const char* c = _string; *c != '\0'; c++)
+			{
+				if (*c == '"' || *c == '\\')
+				{
+					base::write(&_writer, "\\", 1, _err);
+				}
+				base::write(&_writer, c, 1, _err);
+			}
+			base::write(&_writer, "\"", 1, _err);
+		}
+
+	} // namespace
+
+	U64 getNumAllocations()
+	{
+		return s_numAllocations.load(std::memory_order_relaxed);
+	}
+
+	const char* getStageName(BuildStage::Enum _stage)
+	{
+		return kStageNames[_stage];
+	}
+
+	BuildReport::BuildReport()
+		: m_buildStart(base::getHPCounter())
+	{}
+
+	void BuildReport::beginAsset(const char* _name, const char* _type)
+	{
+		pause();
+
+		AssetReport asset;
+		asset.name = _name;
+		asset.type = _type;
+		asset.totalMs = 0.0;
+		for (U32 i = 0; i < BuildStage::Count; i++)
+		{
+			asset.stageMs[i] = 0.0;
+		}
+		asset.inputBytes = 0;
+		asset.outputBytes = 0;
+		asset.numSourceVertices = 0;
+		asset.numWeldedVertices = 0;
+		asset.numVertices = 0;
+		asset.numIndices = 0;
+		asset.numTriangles = 0;
+		asset.numCacheHits = 0;
+		asset.numParseAllocations = 0;
+		asset.parseBytes = 0;
+		asset.numAllocations = 0;
+
+		const U32 index = (U32)m_assets.size();
+		m_assets.push_back(asset);
+		m_assetStack.push_back(index);
+
+		Timer timer;
+		timer.asset = index;
+		timer.stage = -1;
+		timer.start = base::getHPCounter();
+		timer.startAllocations = getNumAllocations();
+		m_timers.push_back(timer);
+	}
+
+	void BuildReport::endAsset()
+	{
+		// Stages left open end with their asset
+		while (!m_timers.empty() && m_timers.back().stage >= 0)
+		{
+			endStage();
+		}
+
+		if (m_timers.empty())
+		{
+			return;
+		}
+
+		pause();
+		m_timers.pop_back();
+		m_assetStack.pop_back();
+		resume();
+	}
+
+	void BuildReport::beginStage(BuildStage::Enum _stage)
+	{
+		if (m_assetStack.empty())
+		{
+			return;
+		}
+
+		pause();
+
+		Timer timer;
+		timer.asset = m_assetStack.back();
+		timer.stage = _stage;
+		timer.start = base::getHPCounter();
+		timer.startAllocations = getNumAllocations();
+		m_timers.push_back(timer);
+	}
+
+	void BuildReport::endStage()
+	{
+		if (m_timers.empty() || m_timers.back().stage < 0)
+		{
+			return;
+		}
+
+		pause();
+		m_timers.pop_back();
+		resume();
+	}
+
+	AssetReport* BuildReport::getAsset()
+	{
+		return m_assetStack.empty() ? NULL : &m_assets[m_assetStack.back()];
+	}
+
+	void BuildReport::pause()
+	{
+		if (m_timers.empty())
+		{
+			return;
+		}
+
+		// The innermost timer runs for both its stage and its asset
+		const Timer& timer = m_timers.back();
+		const F64 elapsedMs = toMs(base::getHPCounter() - timer.start);
+
+		AssetReport& asset = m_assets[timer.asset];
+		asset.totalMs += elapsedMs;
+		asset.numAllocations += getNumAllocations() - timer.startAllocations;
+		if (timer.stage >= 0)
+		{
+			asset.stageMs[timer.stage] += elapsedMs;
+		}
+	}
+
+	void BuildReport::resume()
+	{
+		if (!m_timers.empty())
+		{
+			m_timers.back().start = base::getHPCounter();
+			m_timers.back().startAllocations = getNumAllocations();
+		}
+	}
+
+	void BuildReport::sortBySlowest(std::vector<const AssetReport*>& _out) const
+	{
+		_out.clear();
+		for (const AssetReport& asset : m_assets)
+		{
+			_out.push_back(&asset);
+		}
+
+		std::stable_sort(_out.begin(), _out.end(), [](const AssetReport* _a, const AssetReport* _b)
+			{
+				return _a->totalMs > _b->totalMs;
+			});
+	}
+
+	bool BuildReport::writeJson(const base::FilePath& _filePath) const
+	{
+		base::FileWriter writer;
+		base::Error err;
+		if (!base::open(&writer, _filePath, false, &err))
+		{
+			BASE_TRACE("Failed: Opening %s for writing", _filePath.getCPtr())
+			return false;
+		}
+
+		std::vector<const AssetReport*> assets;
+		sortBySlowest(assets);
+
+		F64 stageMs[BuildStage::Count] = {};
+		for (const AssetReport* asset : assets)
+		{
+			for (U32 i = 0; i < BuildStage::Count; i++)
+			{
+				stageMs[i] += asset->stageMs[i];
+			}
+		}
+
+		char line[512];
+		I32 len = base::snprintf(line, sizeof(line), "{\n\t\"totalMs\": %.3f,\n\t\"stageMs\": {", toMs(base::getHPCounter() - m_buildStart));
+		base::write(&writer, line, len, &err);
+		for (U32 i = 0; i < BuildStage::Count; i++)
+		{
+			len = base::snprintf(line, sizeof(line), "%s\"%s\": %.3f", i > 0 ? ", " : " ", kStageNames[i], stageMs[i]);
+			base::write(&writer, line, len, &err);
+		}
+		writeText(writer, " },\n\t\"assets\": [", &err);
+
+		for (U32 i = 0; i < assets.size(); i++)
+		{
+			const AssetReport& asset = *assets[i];
+
+			writeText(writer, i > 0 ? ",\n\t\t{ \"name\": " : "\n\t\t{ \"name\": ", &err);
+			writeString(writer, asset.name.c_str(), &err);
+			writeText(writer, ", \"type\": ", &err);
+			writeString(writer, asset.type.c_str(), &err);
+
+			len = base::snprintf(line, sizeof(line), ", \"totalMs\": %.3f, \"stageMs\": {", asset.totalMs);
+			base::write(&writer, line, len, &err);
+			for (U32 j = 0; j < BuildStage::Count; j++)
+			{
+				len = base::snprintf(line, sizeof(line), "%s\"%s\": %.3f", j > 0 ? ", " : " ", kStageNames[j], asset.stageMs[j]);
+				base::write(&writer, line, len, &err);
+			}
+
+			const F64 dedupRatio = asset.numSourceVertices > 0 ? F64(asset.numWeldedVertices) / F64(asset.numSourceVertices) : 1.0;
+			len = base::snprintf(line, sizeof(line), " }, \"inputBytes\": %llu, \"outputBytes\": %llu, \"sourceVertices\": %u, "
+				"\"weldedVertices\": %u, \"dedupRatio\": %.4f, \"vertices\": %u, \"indices\": %u, \"triangles\": %u, \"cacheHits\": %u, "
+				"\"parseAllocations\": %u, \"parseBytes\": %llu, \"allocations\": %llu }",
+				(unsigned long long)asset.inputBytes, (unsigned long long)asset.outputBytes, asset.numSourceVertices,
+				asset.numWeldedVertices, dedupRatio, asset.numVertices, asset.numIndices, asset.numTriangles, asset.numCacheHits,
+				asset.numParseAllocations, (unsigned long long)asset.parseBytes, (unsigned long long)asset.numAllocations);
+			base::write(&writer, line, len, &err);
+		}
+
+		writeText(writer, "\n\t]\n}\n", &err);
+		base::close(&writer);
+		return err.isOk();
+	}
+
+	void BuildReport::printSummary(U32 _maxAssets) const
+	{
+		std::vector<const AssetReport*> assets;
+		sortBySlowest(assets);
+
+		F64 stageMs[BuildStage::Count] = {};
+		U64 inputBytes = 0;
+		U64 outputBytes = 0;
+		U32 numTriangles = 0;
+		U64 numAllocations = 0;
+		for (const AssetReport* asset : assets)
+		{
+			for (U32 i = 0; i < BuildStage::Count; i++)
+			{
+				stageMs[i] += asset->stageMs[i];
+			}
+			inputBytes += asset->inputBytes;
+			outputBytes += asset->outputBytes;
+			numTriangles += asset->numTriangles;
+			numAllocations += asset->numAllocations;
+		}
+
+		BASE_TRACE("Build: %d assets in %.1f ms, %.2f MB in, %.2f MB out, %d triangles, %llu allocations", (U32)assets.size(),
+			toMs(base::getHPCounter() - m_buildStart), F64(inputBytes) / (1 << 20), F64(outputBytes) / (1 << 20), numTriangles,
+			(unsigned long long)numAllocations)
+		BASE_TRACE("Stages: parse %.1f ms, triangulate %.1f ms, weld %.1f ms, encode %.1f ms, write %.1f ms",
+			stageMs[BuildStage::Parse], stageMs[BuildStage::Triangulate], stageMs[BuildStage::Weld], stageMs[BuildStage::Encode],
+			stageMs[BuildStage::Write])
+
+		const U32 num = base::min<U32>((U32)assets.size(), _maxAssets);
+		for (U32 i = 0; i < num; i++)
+		{
+			const AssetReport& asset = *assets[i];
+			const F64 dedupRatio = asset.numSourceVertices > 0 ? F64(asset.numWeldedVertices) / F64(asset.numSourceVertices) : 1.0;
+			BASE_TRACE("%8.1f ms %-8s %s (parse %.1f, triangulate %.1f, weld %.1f, encode %.1f, write %.1f), %d triangles, dedup %.2f, %d cache hits, %llu allocations",
+				asset.totalMs, asset.type.c_str(), asset.name.c_str(), asset.stageMs[BuildStage::Parse], asset.stageMs[BuildStage::Triangulate],
+				asset.stageMs[BuildStage::Weld], asset.stageMs[BuildStage::Encode], asset.stageMs[BuildStage::Write], asset.numTriangles,
+				dedupRatio, asset.numCacheHits, (unsigned long long)asset.numAllocations)
+		}
+	}
+
+} // namespace compiler
+
+// Counting replaces the global allocation functions, other threads (like shader builds) count as well
+void* operator new(size_t _size)
+{
+	compiler::s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+	void* ptr = std::malloc(0 != _size ? _size : 1);
+	if (NULL == ptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](size_t _size)
+{
+	return operator new(_size);
+}
+
+void operator delete(void* _ptr) noexcept
+{
+	std::free(_ptr);
+}
+
+void operator delete[](void* _ptr) noexcept
+{
+	std::free(_ptr);
+}
+
+void operator delete(void* _ptr, size_t) noexcept
+{
+	std::free(_ptr);
+}
+
+void operator delete[](void* _ptr, size_t) noexcept
+{
+	std::free(_ptr);
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+// std
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace compiler
+{
+	struct BuildStage
+	{
+		enum Enum
+		{
+			Parse, // Reading and decoding source files
+			Triangulate,
+			Weld, // Merging identical vertices
+			Encode, // Optimizing, simplifying, quantizing and building runtime data
+			Write, // Creating engine resources
+
+			Count
+		};
+	};
+
+	struct AssetReport
+	{
+		std::string name;
+		std::string type;
+		F64 totalMs; // Wall time of this asset, excluding assets imported while it was active
+		F64 stageMs[BuildStage::Count];
+		U64 inputBytes;
+		U64 outputBytes;
+		U32 numSourceVertices; // Triangle corners before welding
+		U32 numWeldedVertices;
+		U32 numVertices; // Written to geometry, all LOD levels
+		U32 numIndices;
+		U32 numTriangles;
+		U32 numCacheHits;
+		U32 numParseAllocations; // Requests made by the FBX parser, served from arenas
+		U64 parseBytes; // Arena memory the FBX parser held at its peak
+		U64 numAllocations; // Heap allocations made while the asset was active, exclusive like its time
+	};
+
+	// Heap allocations made by the compiler so far, counted by the global operator new.
+	U64 getNumAllocations();
+
+	// Lower case name used in the JSON report.
+	const char* getStageName(BuildStage::Enum _stage);
+
+	// Timing and size statistics of every asset in a build, written as JSON and summarized to the log.
+	//
+	// Time is exclusive, a stage or asset started while another one is active pauses the outer one. So
+	// a texture imported by a scene is reported on its own and isn't counted in the scene's time.
+	class BuildReport
+	{
+	public:
+		BuildReport();
+
+		void beginAsset(const char* _name, const char* _type);
+		void endAsset();
+
+		void beginStage(BuildStage::Enum _stage);
+		void endStage();
+
+		// Asset that is currently active, NULL outside of beginAsset/endAsset.
+		AssetReport* getAsset();
+
+		// Assets in the order they began. Times of an asset are final once it ended.
+		U32 getNumAssets() const { return (U32)m_assets.size(); }
+		const AssetReport& getAsset(U32 _index) const { return m_assets[_index]; }
+
+		// Writes assets sorted slowest first.
+		bool writeJson(const base::FilePath& _filePath) const;
+		void printSummary(U32 _maxAssets) const;
+
+	private:
+		struct Timer
+		{
+			U32 asset;
+			I32 stage; // -1 for the asset itself
+			I64 start;
+			U64 startAllocations;
+		};
+
+		void pause();
+		void resume();
+		void sortBySlowest(std::vector<const AssetReport*>& _out) const;
+
+		std::deque<AssetReport> m_assets;
+		std::vector<Timer> m_timers;
+		std::vector<U32> m_assetStack;
+		I64 m_buildStart;
+	};
+
+	// Reports an asset while in scope.
+	class BuildAssetScope
+	{
+	public:
+		BuildAssetScope(BuildReport& _report, const char* _name, const char* _type)
+			: m_report(_report)
+		{
+			m_report.beginAsset(_name, _type);
+		}
+
+		~BuildAssetScope()
+		{
+			m_report.endAsset();
+		}
+
+	private:
+		BuildReport& m_report;
+	};
+
+	// Times a stage of the active asset while in scope.
+	class BuildStageScope
+	{
+	public:
+		BuildStageScope(BuildReport& _report, BuildStage::Enum _stage)
+			: m_report(_report)
+		{
+			m_report.beginStage(_stage);
+		}
+
+		~BuildStageScope()
+		{
+			m_report.endStage();
+		}
+
+	private:
+		BuildReport& m_report;
+	};
+
+} // namespace compiler
@@ -0,0 +1,287 @@
+#include "fbx_loader.h"
+
+// mara
+#include <base/hash.h>
+
+// compiler
+#include "ufbx.h"
+
+// std
+#include <cstdint>
+
+#if BASE_PLATFORM_POSIX
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif // BASE_PLATFORM_POSIX
+
+namespace compiler
+{
+	namespace
+	{
+		constexpr size_t kArenaAlignment = 16;
+
+		size_t alignUp(size_t _value)
+		{
+			return (_value + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+		}
+
+		void* arenaAlloc(void* _user, size_t _size)
+		{
+			return ((ArenaAllocator*)_user)->alloc(_size);
+		}
+
+		void* arenaRealloc(void* _user, void* _ptr, size_t _oldSize, size_t _newSize)
+		{
+			return ((ArenaAllocator*)_user)->realloc(_ptr, _oldSize, _newSize);
+		}
+
+		void arenaFree(void* _user, void* _ptr, size_t _size)
+		{
+			((ArenaAllocator*)_user)->free(_ptr, _size);
+		}
+
+		ufbx_allocator_opts toUfbx(ArenaAllocator& _arena)
+		{
+			// ufbx still batches small allocations into chunks, the arena only replaces the system calls
+			ufbx_allocator_opts opts = {};
+			opts.allocator.alloc_fn = arenaAlloc;
+			opts.allocator.realloc_fn = arenaRealloc;
+			opts.allocator.free_fn = arenaFree;
+			opts.allocator.user = &_arena;
+			return opts;
+		}
+
+		bool openFile(void* _user, ufbx_stream* _stream, const char* _path, size_t _pathLen, const ufbx_open_file_info* _info)
+		{
+			const std::string path(_path, _pathLen);
+			const SourceFile* file = ((SourceFileCache*)_user)->load(path.c_str());
+			if (NULL == file)
+			{
+				return false;
+			}
+
+			// The cache keeps the file alive for longer than the stream
+			ufbx_open_memory_opts opts = {};
+			opts.allocator.allocator = _info->temp_allocator;
+			opts.no_copy = true;
+			return ufbx_open_memory(_stream, file->data, (size_t)file->size, &opts, NULL);
+		}
+
+	} // namespace
+
+	ArenaAllocator::ArenaAllocator(U32 _blockSize)
+		: m_last(NULL)
+		, m_blockSize(_blockSize)
+		, m_reservedBytes(0)
+		, m_peakBytes(0)
+		, m_numAllocations(0)
+		, m_numBlocks(0)
+	{}
+
+	ArenaAllocator::~ArenaAllocator()
+	{
+		reset();
+	}
+
+	void* ArenaAllocator::alloc(size_t _size)
+	{
+		m_numAllocations++;
+
+		const size_t size = alignUp(base::max<size_t>(_size, 1));
+		if (m_blocks.empty() || m_blocks.back().used + size > m_blocks.back().size)
+		{
+			// Large allocations get a block of their own
+			Block block;
+			block.size = base::max(m_blockSize, size);
+			block.data = new U8[block.size];
+			block.used = 0;
+			m_blocks.push_back(block);
+
+			m_numBlocks++;
+			m_reservedBytes += block.size;
+			m_peakBytes = base::max(m_peakBytes, m_reservedBytes);
+		}
+
+		Block& block = m_blocks.back();
+		m_last = block.data + block.used;
+		block.used += size;
+		return m_last;
+	}
+
+	void* ArenaAllocator::realloc(void* _ptr, size_t _oldSize, size_t _newSize)
+	{
+		if (NULL == _ptr)
+		{
+			return alloc(_newSize);
+		}
+
+		if (0 == _newSize)
+		{
+			free(_ptr, _oldSize);
+			return NULL;
+		}
+
+		// Most recent allocation grows or shrinks in place while its block has room
+		if (_ptr == m_last)
+		{
+			Block& block = m_blocks.back();
+			const size_t offset = m_last - block.data;
+			if (offset + alignUp(_newSize) <= block.size)
+			{
+				block.used = offset + alignUp(_newSize);
+				return _ptr;
+			}
+		}
+
+		if (_newSize <= _oldSize)
+		{
+			return _ptr;
+		}
+
+		void* ptr = alloc(_newSize);
+		base::memCopy(ptr, _ptr, (U32)_oldSize);
+		return ptr;
+	}
+
+	void ArenaAllocator::free(void* _ptr, size_t _size)
+	{
+		BASE_UNUSED(_size);
+
+		if (NULL != _ptr && _ptr == m_last)
+		{
+			m_blocks.back().used = m_last - m_blocks.back().data;
+			m_last = NULL;
+		}
+	}
+
+	void ArenaAllocator::reset()
+	{
+		for (Block& block : m_blocks)
+		{
+			delete[] block.data;
+		}
+
+		m_blocks.clear();
+		m_last = NULL;
+		m_reservedBytes = 0;
+	}
+
+	SourceFileCache::SourceFileCache()
+		: m_numHits(0)
+		, m_numLoads(0)
+	{}
+
+	SourceFileCache::~SourceFileCache()
+	{
+		clear();
+	}
+
+	const SourceFile* SourceFileCache::load(const char* _path)
+	{
+		auto it = m_files.find(_path);
+		if (it != m_files.end())
+		{
+			m_numHits++;
+			return &it->second.file;
+		}
+
+		Entry entry;
+		entry.file.data = NULL;
+		entry.file.size = 0;
+		entry.isMapped = false;
+
+#if BASE_PLATFORM_POSIX
+		const int fd = ::open(_path, O_RDONLY);
+		if (fd >= 0)
+		{
+			struct stat st;
+			if (0 == fstat(fd, &st) && st.st_size > 0)
+			{
+				void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (MAP_FAILED != data)
+				{
+					entry.file.data = (const U8*)data;
+					entry.file.size = (U64)st.st_size;
+					entry.isMapped = true;
+				}
+			}
+			::close(fd);
+		}
+#endif // BASE_PLATFORM_POSIX
+
+		if (!entry.isMapped)
+		{
+			base::FileReader reader;
+			base::Error err;
+			if (!base::open(&reader, _path, &err))
+			{
+				return NULL;
+			}
+			entry.buffer.resize((size_t)base::getSize(&reader));
+			base::read(&reader, entry.buffer.data(), (I32)entry.buffer.size(), &err);
+			base::close(&reader);
+
+			entry.file.data = entry.buffer.data();
+			entry.file.size = entry.buffer.size();
+		}
+
+		m_numLoads++;
+
+		// Entries are node based and moving the buffer keeps its storage, pointers stay valid
+		Entry& inserted = m_files[_path];
+		inserted = std::move(entry);
+		return &inserted.file;
+	}
+
+	U32 SourceFileCache::hashContents() const
+	{
+		// Summed so the unordered map's iteration order doesn't matter
+		U32 hash = 0;
+		for (const auto& it : m_files)
+		{
+			hash += base::hash<base::HashMurmur2A>(it.second.file.data, (U32)it.second.file.size);
+		}
+
+		return hash;
+	}
+
+	void SourceFileCache::clear()
+	{
+#if BASE_PLATFORM_POSIX
+		for (auto& it : m_files)
+		{
+			if (it.second.isMapped)
+			{
+				munmap((void*)it.second.file.data, (size_t)it.second.file.size);
+			}
+		}
+#endif // BASE_PLATFORM_POSIX
+
+		m_files.clear();
+	}
+
+	ufbx_scene* loadFbx(const char* _path, SourceFileCache& _files, ArenaAllocator& _temp, ArenaAllocator& _result,
+		ufbx_error* _error)
+	{
+		const SourceFile* file = _files.load(_path);
+		if (NULL == file)
+		{
+			return NULL;
+		}
+
+		ufbx_load_opts opts = {};
+		opts.temp_allocator = toUfbx(_temp);
+		opts.result_allocator = toUfbx(_result);
+		opts.open_file_cb.fn = openFile;
+		opts.open_file_cb.user = &_files;
+
+		// Relative paths of external files and the file format are derived from the name
+		opts.filename.data = _path;
+		opts.filename.length = SIZE_MAX;
+
+		return ufbx_load_memory(file->data, (size_t)file->size, &opts, _error);
+	}
+
+} // namespace compiler
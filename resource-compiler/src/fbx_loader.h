@@ -0,0 +1,97 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+// std
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ufbx_scene;
+struct ufbx_error;
+
+namespace compiler
+{
+	// Linear allocator, memory is only given back all at once. Frees of the most recent allocation
+	// rewind the arena so temporary buffers that grow and shrink don't leave holes.
+	class ArenaAllocator
+	{
+	public:
+		explicit ArenaAllocator(U32 _blockSize = 4 << 20);
+		~ArenaAllocator();
+
+		void* alloc(size_t _size);
+		void* realloc(void* _ptr, size_t _oldSize, size_t _newSize);
+		void free(void* _ptr, size_t _size);
+
+		// Releases every block, pointers handed out before are invalid afterwards.
+		void reset();
+
+		U32 getNumAllocations() const { return m_numAllocations; } // Calls to alloc and growing reallocs
+		U32 getNumBlocks() const { return m_numBlocks; } // Allocations made from the system
+		U64 getPeakBytes() const { return m_peakBytes; } // Most memory reserved at once
+
+	private:
+		struct Block
+		{
+			U8* data;
+			size_t size;
+			size_t used;
+		};
+
+		std::vector<Block> m_blocks;
+		U8* m_last; // Most recent allocation, the only one that can grow in place
+		size_t m_blockSize;
+		U64 m_reservedBytes;
+		U64 m_peakBytes;
+		U32 m_numAllocations;
+		U32 m_numBlocks;
+	};
+
+	struct SourceFile
+	{
+		const U8* data;
+		U64 size;
+	};
+
+	// Source files read once and shared between everything that imports them, memory mapped where
+	// the platform allows it.
+	class SourceFileCache
+	{
+	public:
+		SourceFileCache();
+		~SourceFileCache();
+
+		// Returns NULL if the file can't be opened.
+		const SourceFile* load(const char* _path);
+
+		// Unmaps every file, pointers returned before are invalid afterwards.
+		void clear();
+
+		// Hash over the contents of every loaded file, independent of load order.
+		U32 hashContents() const;
+
+		U32 getNumHits() const { return m_numHits; }
+		U32 getNumLoads() const { return m_numLoads; }
+
+	private:
+		struct Entry
+		{
+			SourceFile file;
+			bool isMapped;
+			std::vector<U8> buffer; // Contents when the file isn't mapped
+		};
+
+		std::unordered_map<std::string, Entry> m_files;
+		U32 m_numHits;
+		U32 m_numLoads;
+	};
+
+	// Parses an FBX file from the cache with every allocation served by the arenas. Temporary memory
+	// can be reset once this returns, result memory must outlive ufbx_free_scene. External files the
+	// scene references, like geometry caches, resolve from the cache too.
+	ufbx_scene* loadFbx(const char* _path, SourceFileCache& _files, ArenaAllocator& _temp, ArenaAllocator& _result,
+		ufbx_error* _error);
+
+} // namespace compiler
@@ -0,0 +1,44 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+#include <base/hash.h>
+
+namespace compiler
+{
+	// Uncompressed vertex as produced by the FBX importer.
+	struct MeshVertex
+	{
+		float x;
+		float y;
+		float z;
+		float u;
+		float v;
+		float nx;
+		float ny;
+		float nz;
+
+		bool operator==(const MeshVertex& other) const
+		{
+			return x == other.x && y == other.y && z == other.z &&
+				u == other.u && v == other.v &&
+				nx == other.nx && ny == other.ny && nz == other.nz;
+		}
+	};
+
+	// For looking vertices up by value, -0 and 0 hash the same as they compare equal.
+	struct MeshVertexHash
+	{
+		size_t operator()(const MeshVertex& _vertex) const
+		{
+			const F32 values[] =
+			{
+				_vertex.x + 0.0f, _vertex.y + 0.0f, _vertex.z + 0.0f,
+				_vertex.u + 0.0f, _vertex.v + 0.0f,
+				_vertex.nx + 0.0f, _vertex.ny + 0.0f, _vertex.nz + 0.0f,
+			};
+			return base::hash<base::HashMurmur2A>(values, sizeof(values));
+		}
+	};
+
+} // namespace compiler
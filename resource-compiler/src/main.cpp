@@ -9,53 +9,162 @@
 #include "stbimage.h"
 #include "ufbx.h"
 
+// compiler
+#include "build_report.h"
+#include "fbx_loader.h"
+#include "meshlet.h"
+#include "mesh_optimize.h"
+#include "mesh_simplify.h"
+#include "morph_target.h"
+#include "pakx_writer.h"
+#include "program_table.h"
+#include "shader_build.h"
+#include "static_batch.h"
+#include "texture_array.h"
+#include "texture_stream.h"
+#include "throughput_benchmark.h"
+#include "vertex_quantize.h"
+
 // std
-#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace 
 {
-	#define RESOURCE_LOCATION "C:/Users/marcu/Dev/mara-demo/resource-compiler/resources/"
+	// Directories from the command line, defaults are relative to the resource-compiler directory
+	struct Paths
+	{
+		Paths()
+			: resources("resources/")
+			, output("../demo/build/bin/data/")
+			, shaderCache("build/shadercache/")
+		{}
 
-	mara::ResourceHandle importShader(const base::FilePath& _shaderPath, const base::FilePath& _varyingPath, graphics::ShaderType::Enum _type,
-		const base::FilePath& _outVfp)
+		std::string resources; // Source FBX, textures and shaders, --resources
+		std::string output; // PAK, sidecar and reports, --output
+		std::string shaderCache; // Compiled shader variants kept between builds, --shader-cache
+	};
+
+	Paths s_paths;
+
+	void setDir(std::string& _dir, const char* _arg)
 	{
-		mara::ShaderCreate data;
-		int argc = 0;
-		const char* argv[11];
-
-		const char* type = "";
-		if (_type == graphics::ShaderType::Vertex)   type = "v";
-		if (_type == graphics::ShaderType::Fragment) type = "f";
-		if (_type == graphics::ShaderType::Compute)  type = "c";
-
-		argv[argc++] = "-f";
-		argv[argc++] = _shaderPath.getCPtr();
-		argv[argc++] = "--varyingdef";
-		argv[argc++] = _varyingPath.getCPtr();
-		argv[argc++] = "--type";
-		argv[argc++] = type;
-		argv[argc++] = "--platform";
-		argv[argc++] = "windows";
-		argv[argc++] = "--profile";
-		argv[argc++] = "s_5_0";
-		argv[argc++] = "--O";
-		data.mem = graphics::compileShader(argc, argv);
-
-		if (data.mem)
-		{
-			BASE_TRACE("Success: Loading shader at %s", _shaderPath.getCPtr())
-			return mara::createResource(data, _outVfp);
+		_dir = _arg;
+		if (!_dir.empty() && _dir.back() != '/' && _dir.back() != '\\')
+		{
+			_dir += '/';
 		}
-		else
+	}
+
+	void initPaths(I32 _argc, const char* const* _argv)
+	{
+		for (I32 i = 1; i + 1 < _argc; i++)
 		{
-			BASE_TRACE("Failed: Loading shader at %s", _shaderPath.getCPtr())
-			return MARA_INVALID_HANDLE;
+			if (0 == std::strcmp(_argv[i], "--resources"))
+			{
+				setDir(s_paths.resources, _argv[i + 1]);
+			}
+			else if (0 == std::strcmp(_argv[i], "--output"))
+			{
+				setDir(s_paths.output, _argv[i + 1]);
+			}
+			else if (0 == std::strcmp(_argv[i], "--shader-cache"))
+			{
+				setDir(s_paths.shaderCache, _argv[i + 1]);
+			}
 		}
-		
 	}
 
-	mara::ResourceHandle importTexture(const base::FilePath& _filePath,
+	std::string resourcePath(const char* _name)
+	{
+		return s_paths.resources + _name;
+	}
+
+	std::string outputPath(const char* _name)
+	{
+		return s_paths.output + _name;
+	}
+
+	struct Settings
+	{
+		Settings()
+			: streamTextures(true)
+			, quantizeVertices(true)
+			, normalBits(16)
+			, optimizeMeshes(true)
+			, optimizeOverdraw(true)
+			, vertexCacheSize(16)
+			, numLods(4)
+			, lodReduction(0.5f)
+			, lodMaxError(0.05f)
+			, buildMeshlets(true)
+			, mergeStaticMeshes(true)
+			, batchMaxVertices(UINT16_MAX)
+			, batchMaxExtent(32.0f)
+			, shaderThreads(base::max(1u, std::thread::hardware_concurrency()))
+			, textureArrays(false)
+		{}
+
+		// Covers every setting that changes the output, shaderThreads only changes how it's built
+		U32 hashOutput() const
+		{
+			base::HashMurmur2A hash;
+			hash.begin();
+			hash.add(streamTextures);
+			hash.add(quantizeVertices);
+			hash.add(normalBits);
+			hash.add(optimizeMeshes);
+			hash.add(optimizeOverdraw);
+			hash.add(vertexCacheSize);
+			hash.add(numLods);
+			hash.add(lodReduction);
+			hash.add(lodMaxError);
+			hash.add(buildMeshlets);
+			hash.add(mergeStaticMeshes);
+			hash.add(batchMaxVertices);
+			hash.add(batchMaxExtent);
+			hash.add(textureArrays);
+			return hash.end();
+		}
+
+		bool streamTextures; // Write material textures with full mip chains to the .pakx instead of the PAK
+		bool quantizeVertices; // Write compact vertices instead of 32 byte float vertices
+		U32 normalBits; // Octahedral normal precision per component when quantizing, 8 or 16
+		bool optimizeMeshes; // Reorder triangles and vertices for the post-transform cache and vertex fetch
+		bool optimizeOverdraw; // Also sort triangle clusters to reduce overdraw, needs optimizeMeshes
+		U32 vertexCacheSize; // Post-transform cache size to optimize for
+		U32 numLods; // Max number of LOD levels per mesh including the full mesh, 1 disables LODs
+		F32 lodReduction; // Triangle count of each LOD level relative to the previous one
+		F32 lodMaxError; // Max simplification error relative to the mesh bounding radius
+		bool buildMeshlets; // Split meshes into clusters with culling bounds, written to the .pakx
+		bool mergeStaticMeshes; // Merge meshes of static scenes sharing a material into batches
+		U32 batchMaxVertices; // Max vertices per batch, geometry uses 16 bit indices
+		F32 batchMaxExtent; // Max world space size of a batch so batches can still be culled
+		U32 shaderThreads; // Threads hashing and looking up shader variants in the cache, shaderc compiles one at a time
+		bool textureArrays; // Pack material textures into arrays by size and draw instanced, replaces streamTextures
+	};
+
+	Settings s_settings;
+	compiler::TextureStreamBuilder s_textureStream;
+	compiler::PrefabTableBuilder s_prefabTable;
+	compiler::MeshletTableBuilder s_meshletTable;
+	compiler::MorphTableBuilder s_morphTable;
+	compiler::ShaderBuilder s_shaders;
+	compiler::ProgramTableBuilder s_programTable;
+	compiler::MaterialTableBuilder s_materialTable;
+	compiler::TextureArrayBuilder s_textureArrays;
+	compiler::ResourceTableBuilder s_resourceTable;
+	compiler::BuildReport s_report;
+	compiler::SourceFileCache s_sourceFiles;
+
+	mara::ResourceHandle importTexture(const void* _data, U32 _size, const base::FilePath& _filePath,
 		const base::FilePath& _outVfp)
 	{
 		// Flip image parsing
@@ -63,7 +172,7 @@ namespace
 
 		// Load image using stbi
 		int texWidth, texHeight, texChannels;
-		unsigned char* texData = stbi_load(_filePath.getCPtr(), &texWidth, &texHeight, &texChannels, STBI_rgb);
+		unsigned char* texData = stbi_load_from_memory((const stbi_uc*)_data, (int)_size, &texWidth, &texHeight, &texChannels, STBI_rgb);
 
 		// If image is valid, create engine texture resource
 		if (NULL != texData)
@@ -79,9 +188,14 @@ namespace
 			texture.hasMips = texMips;
 			texture.format = texFormat;
 			texture.mem = texData;
-			texture.memSize = texWidth * texHeight * texChannels;
+			texture.memSize = texWidth * texHeight * 3; // STBI_rgb always outputs 3 channels
+
+			// Most renderers expand RGB8 to RGBA8 on upload
+			s_resourceTable.addResource(_outVfp, pakx::ResourceType::Texture, texture.memSize, texWidth * texHeight * 4);
+			s_report.getAsset()->outputBytes += texture.memSize;
 
 			BASE_TRACE("Success: Loading texture at %s", _filePath.getCPtr())
+			compiler::BuildStageScope stage(s_report, compiler::BuildStage::Write);
 			return mara::createResource(texture, _outVfp);
 		}
 		else
@@ -91,50 +205,654 @@ namespace
 		}
 	}
 
-	mara::ResourceHandle importScene(const base::FilePath& _fbxPath, 
+	U32 streamTexture(const void* _data, U32 _size, const base::FilePath& _filePath,
 		const base::FilePath& _outVfp)
 	{
-		struct MeshVertex
+		// Flip image parsing
+		stbi_set_flip_vertically_on_load(true);
+
+		// Streamed textures are always RGBA8 so mip sizes match what is resident on the GPU
+		int texWidth, texHeight, texChannels;
+		unsigned char* texData = stbi_load_from_memory((const stbi_uc*)_data, (int)_size, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+
+		if (NULL != texData)
 		{
-			float x;
-			float y;
-			float z;
-			float u;
-			float v;
-			float nx;
-			float ny;
-			float nz;
+			const U32 index = s_textureStream.addTexture(_outVfp, texData, (U16)texWidth, (U16)texHeight);
+			stbi_image_free(texData);
+
+			// Full mip chain adds a third
+			s_report.getAsset()->outputBytes += U64(texWidth) * texHeight * 4 * 4 / 3;
+
+			BASE_TRACE("Success: Loading streamed texture at %s", _filePath.getCPtr())
+			return index;
+		}
+		else
+		{
+			BASE_TRACE("Failed: Loading streamed texture at %s", _filePath.getCPtr())
+			return pakx::kInvalidIndex;
+		}
+	}
+
+	bool arrayTexture(const void* _data, U32 _size, const base::FilePath& _filePath, U32* _outArray, U32* _outLayer)
+	{
+		// Flip image parsing
+		stbi_set_flip_vertically_on_load(true);
+
+		// Array layers are RGBA8 like streamed textures
+		int texWidth, texHeight, texChannels;
+		unsigned char* texData = stbi_load_from_memory((const stbi_uc*)_data, (int)_size, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
-			bool operator==(const MeshVertex& other) const
+		if (NULL != texData)
+		{
+			const bool added = s_textureArrays.addTexture(texData, (U16)texWidth, (U16)texHeight, _outArray, _outLayer);
+			stbi_image_free(texData);
+
+			// Full mip chain adds a third
+			s_report.getAsset()->outputBytes += U64(texWidth) * texHeight * 4 * 4 / 3;
+
+			BASE_TRACE("Success: Loading texture array layer at %s", _filePath.getCPtr())
+			return added;
+		}
+		else
+		{
+			BASE_TRACE("Failed: Loading texture array layer at %s", _filePath.getCPtr())
+			return false;
+		}
+	}
+
+	// Texture cache shared by every scene imported during a build. Materials that reference the same
+	// image file (or a different file with identical content) resolve to the same texture resource, so
+	// each unique image is decoded and written exactly once.
+	class TextureCache
+	{
+	public:
+		struct Entry
+		{
+			mara::ResourceHandle handle;
+			U32 streamIndex;
+			U32 arrayIndex;
+			U32 arrayLayer;
+			std::string vfp;
+			std::string sourcePath; // File first imported with this content, compared against on hash hits
+			U32 contentHash;
+		};
+
+		TextureCache()
+			: m_numHits(0)
+			, m_numMisses(0)
+		{}
+
+		const Entry* import(const char* _absolutePath)
+		{
+			const std::string key = normalizePath(_absolutePath);
+
+			// Same source file already imported
+			auto pathIt = m_pathToEntry.find(key);
+			if (pathIt != m_pathToEntry.end())
 			{
-				return x == other.x && y == other.y && z == other.z &&
-					u == other.u && v == other.v &&
-					nx == other.nx && ny == other.ny && nz == other.nz;
+				// Still a source of the prefab being built, its content hash covers the texture
+				s_sourceFiles.load(_absolutePath);
+
+				m_numHits++;
+				s_report.getAsset()->numCacheHits++;
+				return &m_entries[pathIt->second];
 			}
-		};
 
-		// Load FBX
-		ufbx_load_opts opts = {};
-		ufbx_error err;
-		ufbx_scene* scene = ufbx_load_file(_fbxPath.getCPtr(), &opts, &err);
+			compiler::BuildAssetScope asset(s_report, _absolutePath, "texture");
+
+			// Read source file once, the bytes are both hashed and decoded
+			const compiler::SourceFile* file = NULL;
+			U32 contentHash;
+			{
+				compiler::BuildStageScope stage(s_report, compiler::BuildStage::Parse);
+
+				file = s_sourceFiles.load(_absolutePath);
+				if (NULL == file)
+				{
+					BASE_TRACE("Failed: Opening texture at %s", _absolutePath)
+					return NULL;
+				}
+
+				contentHash = base::hash<base::HashMurmur2A>(file->data, (U32)file->size);
+				s_report.getAsset()->inputBytes += file->size;
+			}
+			const U8* data = file->data;
+			const U32 size = (U32)file->size;
+
+			// Different file with identical content already imported, a matching hash alone may be a collision
+			const U64 contentKey = (U64(size) << 32) | contentHash;
+			const auto range = m_contentToEntry.equal_range(contentKey);
+			U32 numCollisions = 0;
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				const Entry& cached = m_entries[it->second];
+				const compiler::SourceFile* cachedFile = s_sourceFiles.load(cached.sourcePath.c_str());
+				if (NULL != cachedFile && cachedFile->size == file->size && 0 == std::memcmp(cachedFile->data, data, size))
+				{
+					m_numHits++;
+					s_report.getAsset()->numCacheHits++;
+					m_pathToEntry[key] = it->second;
+					return &cached;
+				}
+				numCollisions++;
+			}
+
+			// Virtual path includes the content hash so files sharing a base name don't collide
+			char hashAsString[32];
+			if (0 == numCollisions)
+			{
+				base::snprintf(hashAsString, sizeof(hashAsString), "_%08x", contentHash);
+			}
+			else
+			{
+				base::snprintf(hashAsString, sizeof(hashAsString), "_%08x_%u", contentHash, numCollisions);
+			}
+
+			base::FilePath texturePath = "textures";
+			texturePath.join(base::FilePath(_absolutePath).getBaseName());
+			texturePath.join(hashAsString, false);
+			texturePath.join(".bin", false);
+
+			Entry entry;
+			entry.handle = MARA_INVALID_HANDLE;
+			entry.streamIndex = pakx::kInvalidIndex;
+			entry.arrayIndex = pakx::kInvalidIndex;
+			entry.arrayLayer = 0;
+			{
+				// Decoding counts as encoding, the source file was read above
+				compiler::BuildStageScope stage(s_report, compiler::BuildStage::Encode);
+				if (s_settings.textureArrays)
+				{
+					if (!arrayTexture(data, size, _absolutePath, &entry.arrayIndex, &entry.arrayLayer))
+					{
+						return NULL;
+					}
+				}
+				else if (s_settings.streamTextures)
+				{
+					entry.streamIndex = streamTexture(data, size, _absolutePath, texturePath);
+				}
+				else
+				{
+					entry.handle = importTexture(data, size, _absolutePath, texturePath);
+				}
+			}
+			entry.vfp = texturePath.getCPtr();
+			entry.sourcePath = key;
+			entry.contentHash = contentHash;
+			m_numMisses++;
+
+			const U32 index = (U32)m_entries.size();
+			m_entries.push_back(entry);
+			m_pathToEntry[key] = index;
+			m_contentToEntry.emplace(contentKey, index);
+			return &m_entries[index];
+		}
+
+		U32 getNumHits() const { return m_numHits; }
+		U32 getNumMisses() const { return m_numMisses; }
+
+	private:
+		static std::string normalizePath(const char* _path)
+		{
+			std::string path = _path;
+			std::replace(path.begin(), path.end(), '\\', '/');
+			return path;
+		}
+
+		std::deque<Entry> m_entries;
+		std::unordered_map<std::string, U32> m_pathToEntry;
+		std::unordered_multimap<U64, U32> m_contentToEntry; // Size in the high 32 bits, content hash in the low ones
+		U32 m_numHits;
+		U32 m_numMisses;
+	};
+
+	TextureCache s_textureCache;
+
+	using compiler::MeshVertex;
+
+	struct Lod
+	{
+		std::vector<MeshVertex> vertices;
+		std::vector<U32> indices;
+		std::vector<U32> sourceVertices; // FBX vertex of each vertex, only kept for meshes with morph targets
+		F32 error; // Mesh space distance to the full mesh
+		F32 threshold; // Authored levels only, see pakx::Mesh::lodThreshold
+	};
+
+	void optimizeMesh(Lod& _lod, const char* _name)
+	{
+		std::vector<U32> remap;
+
+		// Optimize for post-transform cache, overdraw and vertex fetch
+		if (s_settings.optimizeMeshes)
+		{
+			const U32 numVertices = (U32)_lod.vertices.size();
+			const compiler::VertexCacheStats before = compiler::analyzeVertexCache(_lod.indices, numVertices, s_settings.vertexCacheSize);
+
+			std::vector<U32> clusters;
+			compiler::optimizeVertexCache(_lod.indices, numVertices, s_settings.vertexCacheSize, s_settings.optimizeOverdraw ? &clusters : NULL);
+			if (s_settings.optimizeOverdraw)
+			{
+				compiler::optimizeOverdraw(_lod.indices, _lod.vertices, clusters, 64);
+			}
+			compiler::optimizeVertexFetch(_lod.vertices, _lod.indices, &remap);
+
+			const compiler::VertexCacheStats after = compiler::analyzeVertexCache(_lod.indices, (U32)_lod.vertices.size(), s_settings.vertexCacheSize);
+			BASE_TRACE("Optimized %s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", _name,
+				before.acmr, after.acmr, before.atvr, after.atvr)
+		}
+		else
+		{
+			// Still drop vertices no longer referenced, simplified levels leave plenty
+			compiler::optimizeVertexFetch(_lod.vertices, _lod.indices, &remap);
+		}
+
+		// Sources follow their vertices
+		if (!_lod.sourceVertices.empty())
+		{
+			std::vector<U32> sourceVertices(remap.size());
+			for (U32 i = 0; i < remap.size(); i++)
+			{
+				sourceVertices[i] = _lod.sourceVertices[remap[i]];
+			}
+			_lod.sourceVertices.swap(sourceVertices);
+		}
+	}
+
+	void computeBounds(pakx::Mesh& _record, const std::vector<MeshVertex>& _vertices)
+	{
+		// Bounding sphere in mesh space
+		base::memSet(&_record, 0, sizeof(_record));
+		_record.texture = pakx::kInvalidIndex;
+
+		base::Vec3 min = { base::kFloatMax, base::kFloatMax, base::kFloatMax };
+		base::Vec3 max = { -base::kFloatMax, -base::kFloatMax, -base::kFloatMax };
+		for (const MeshVertex& vertex : _vertices)
+		{
+			min = base::min(min, { vertex.x, vertex.y, vertex.z });
+			max = base::max(max, { vertex.x, vertex.y, vertex.z });
+		}
+
+		const base::Vec3 center = base::mul(base::add(min, max), 0.5f);
+		F32 radius = 0.0f;
+		for (const MeshVertex& vertex : _vertices)
+		{
+			radius = base::max(radius, base::length(base::sub({ vertex.x, vertex.y, vertex.z }, center)));
+		}
+
+		_record.center[0] = center.x;
+		_record.center[1] = center.y;
+		_record.center[2] = center.z;
+		_record.radius = radius;
+	}
+
+	base::FilePath createGeometry(const std::vector<MeshVertex>& _vertices, const std::vector<U32>& _indices,
+		compiler::QuantizedVertices& _quantized)
+	{
+		// Narrowed to the engine's 16 bit indices, importScene splits meshes that would need more
+		base::FilePath geometryPath = base::FilePath("geometry");
+		if (_vertices.size() > UINT16_MAX)
+		{
+			BASE_TRACE("Failed: Geometry with %d vertices can't use 16 bit indices", (U32)_vertices.size())
+			return geometryPath;
+		}
+		std::vector<U16> indices16(_indices.begin(), _indices.end());
+
+		mara::GeometryCreate geometry;
+		if (s_settings.quantizeVertices)
+		{
+			compiler::quantizeVertices(_quantized, _vertices, s_settings.normalBits);
+
+			geometry.vertices = _quantized.data.data();
+			geometry.verticesSize = _quantized.data.size();
+			geometry.layout = _quantized.layout;
+		}
+		else
+		{
+			graphics::VertexLayout layout;
+			layout.begin()
+				.add(graphics::Attrib::Position, 3, graphics::AttribType::Float)
+				.add(graphics::Attrib::TexCoord0, 2, graphics::AttribType::Float)
+				.add(graphics::Attrib::Normal, 3, graphics::AttribType::Float)
+				.end();
+
+			geometry.vertices = (void*)_vertices.data();
+			geometry.verticesSize = _vertices.size() * sizeof(MeshVertex);
+			geometry.layout = layout;
+		}
+		geometry.indices = indices16.data();
+		geometry.indicesSize = indices16.size() * sizeof(U16);
+
+		{
+			U32 hash = base::hash<base::HashMurmur2A>(geometry.vertices, geometry.verticesSize);
+			std::string hashAsString = std::to_string(hash);
+			geometryPath.join(hashAsString.c_str());
+		}
+		geometryPath.join(".bin", false);
+		{
+			compiler::BuildStageScope stage(s_report, compiler::BuildStage::Write);
+			mara::createResource(geometry, geometryPath);
+		}
+		s_resourceTable.addResource(geometryPath, pakx::ResourceType::Geometry, geometry.verticesSize + geometry.indicesSize,
+			geometry.verticesSize + geometry.indicesSize);
+
+		compiler::AssetReport* asset = s_report.getAsset();
+		asset->outputBytes += geometry.verticesSize + geometry.indicesSize;
+		asset->numVertices += (U32)_vertices.size();
+		asset->numIndices += (U32)_indices.size();
+		asset->numTriangles += (U32)_indices.size() / 3;
+
+		return geometryPath;
+	}
+
+	// Writes geometry, meshlets, blend shapes and the mesh resource of one LOD level of a mesh.
+	void createMeshLevel(const compiler::SceneMesh& _mesh, const Lod& _lod, U32 _level, U32 _numLods, U32 _lodFlags,
+		F32 _baseRadius, std::vector<std::string>& _meshes, std::vector<pakx::Mesh>& _meshRecords)
+	{
+		pakx::Mesh record;
+		computeBounds(record, _lod.vertices);
+		record.texture = _mesh.texture;
+		record.textureArray = _mesh.textureArray;
+		record.program = _mesh.program;
+		record.material = _mesh.material;
+		record.lod = (U8)_level;
+		record.numLods = (U8)_numLods;
+		record.lodError = _baseRadius > 0.0f ? _lod.error / _baseRadius : 0.0f;
+		record.lodThreshold = _lod.threshold;
+		record.lodFlags = _lodFlags;
+		record.node = _mesh.node;
+
+		// Create Geometry Resource
+		compiler::QuantizedVertices quantized;
+		const base::FilePath geometryPath = createGeometry(_lod.vertices, _lod.indices, quantized);
+		if (s_settings.quantizeVertices)
+		{
+			// Bounds move into quantized space with the vertices
+			record.center[0] = (record.center[0] - quantized.dequantBias[0]) / quantized.dequantScale;
+			record.center[1] = (record.center[1] - quantized.dequantBias[1]) / quantized.dequantScale;
+			record.center[2] = (record.center[2] - quantized.dequantBias[2]) / quantized.dequantScale;
+			record.radius /= quantized.dequantScale;
+		}
+
+		// Build meshlets, bounds follow the vertices into quantized space
+		if (s_settings.buildMeshlets)
+		{
+			compiler::MeshletBuild meshlets;
+			compiler::buildMeshlets(meshlets, _lod.vertices, _lod.indices, pakx::kMaxMeshletVertices, pakx::kMaxMeshletTriangles);
+			if (s_settings.quantizeVertices)
+			{
+				for (pakx::Meshlet& meshlet : meshlets.meshlets)
+				{
+					meshlet.center[0] = (meshlet.center[0] - quantized.dequantBias[0]) / quantized.dequantScale;
+					meshlet.center[1] = (meshlet.center[1] - quantized.dequantBias[1]) / quantized.dequantScale;
+					meshlet.center[2] = (meshlet.center[2] - quantized.dequantBias[2]) / quantized.dequantScale;
+					meshlet.radius /= quantized.dequantScale;
+				}
+			}
+
+			record.firstMeshlet = s_meshletTable.add(meshlets);
+			record.numMeshlets = (U32)meshlets.meshlets.size();
+		}
+
+		// Resolve blend shapes onto the vertices of this level, deltas follow them into quantized space
+		if (!_mesh.morphTargets.empty())
+		{
+			std::vector<compiler::MorphTargetBuild> morphTargets;
+			compiler::buildMorphTargets(morphTargets, _mesh.morphTargets, _lod.sourceVertices,
+				s_settings.quantizeVertices ? quantized.dequantScale : 1.0f);
+
+			const U32 numDeltas = s_morphTable.getNumDeltas();
+			record.firstMorphTarget = s_morphTable.add(morphTargets);
+			record.numMorphTargets = (U32)morphTargets.size();
+			s_report.getAsset()->outputBytes += (s_morphTable.getNumDeltas() - numDeltas) * sizeof(pakx::MorphDelta);
+		}
+
+		// Create Mesh Resource
+		base::FilePath meshPath = base::FilePath("meshes");
+		{
+			mara::MeshCreate mesh;
+			mesh.geometryPath = geometryPath;
+			mesh.materialPath = _mesh.materialPath.c_str();
+
+			// Meshes of a node are relative to it, the runtime resolves the hierarchy
+			base::memCopy(mesh.m_transform, _mesh.node != pakx::kInvalidIndex ? _mesh.nodeTransform : _mesh.transform,
+				sizeof(mesh.m_transform));
+
+			// Dequantization constants live in the mesh transform
+			if (s_settings.quantizeVertices)
+			{
+				compiler::applyDequantization(mesh.m_transform, quantized);
+			}
+
+			meshPath.join(_mesh.name.c_str());
+			if (_level > 0 && 0 == (_lodFlags & pakx::kLodAuthored))
+			{
+				char lodSuffix[16];
+				base::snprintf(lodSuffix, sizeof(lodSuffix), "_lod%d", _level);
+				meshPath.join(lodSuffix, false);
+			}
+			meshPath.join(".bin", false);
+			{
+				compiler::BuildStageScope stage(s_report, compiler::BuildStage::Write);
+				mara::createResource(mesh, meshPath);
+			}
+			s_resourceTable.addResource(meshPath, pakx::ResourceType::Mesh, sizeof(mara::MeshCreate), 0);
+		}
+
+		_meshes.push_back(meshPath.getCPtr());
+		_meshRecords.push_back(record);
+	}
+
+	void createMesh(const compiler::SceneMesh& _mesh, std::vector<std::string>& _meshes, std::vector<pakx::Mesh>& _meshRecords)
+	{
+		// Build LOD chain, level 0 is the full mesh. Every level is simplified from the full mesh so the
+		// error is always measured against the original surface.
+		std::vector<Lod> lods(1);
+		lods[0].vertices = _mesh.vertices;
+		lods[0].indices = _mesh.indices;
+		lods[0].sourceVertices = _mesh.sourceVertices;
+		lods[0].error = 0.0f;
+		lods[0].threshold = 0.0f;
+		optimizeMesh(lods[0], _mesh.name.c_str());
+
+		pakx::Mesh baseRecord;
+		computeBounds(baseRecord, lods[0].vertices);
+
+		for (U32 level = 1; level < s_settings.numLods; level++)
+		{
+			const U32 previousIndexCount = (U32)lods.back().indices.size();
+			const U32 targetIndexCount = U32(previousIndexCount * s_settings.lodReduction) / 3 * 3;
+
+			Lod lod;
+			lod.vertices = _mesh.vertices;
+			lod.sourceVertices = _mesh.sourceVertices;
+			lod.threshold = 0.0f;
+			lod.error = compiler::simplifyMesh(lod.indices, _mesh.vertices, _mesh.indices, targetIndexCount,
+				s_settings.lodMaxError * baseRecord.radius);
+			lod.error = base::max(lod.error, lods.back().error);
+
+			// Stop once simplification no longer pays off
+			if (lod.indices.empty() || lod.indices.size() > previousIndexCount * 0.9f)
+			{
+				break;
+			}
+
+			optimizeMesh(lod, _mesh.name.c_str());
+			lods.push_back(lod);
+		}
+
+		for (U32 level = 0; level < lods.size(); level++)
+		{
+			createMeshLevel(_mesh, lods[level], level, (U32)lods.size(), 0, baseRecord.radius, _meshes, _meshRecords);
+		}
+	}
+
+	// Writes the meshes of an FBX LOD group as the levels of one mesh. Levels keep their own geometry,
+	// material and transform, the runtime picks one of them by its threshold.
+	void createLodGroup(const std::vector<const compiler::SceneMesh*>& _levels, bool _isScreenPercent,
+		std::vector<std::string>& _meshes, std::vector<pakx::Mesh>& _meshRecords)
+	{
+		const U32 lodFlags = pakx::kLodAuthored | (_isScreenPercent ? pakx::kLodScreenPercent : 0);
+
+		for (U32 level = 0; level < _levels.size(); level++)
+		{
+			const compiler::SceneMesh& mesh = *_levels[level];
+
+			Lod lod;
+			lod.vertices = mesh.vertices;
+			lod.indices = mesh.indices;
+			lod.sourceVertices = mesh.sourceVertices;
+			lod.error = 0.0f;
+			lod.threshold = mesh.lodThreshold;
+			optimizeMesh(lod, mesh.name.c_str());
+
+			createMeshLevel(mesh, lod, level, (U32)_levels.size(), lodFlags, 0.0f, _meshes, _meshRecords);
+		}
+	}
+
+
+	// FBX matrices are column vectors, the runtime uses row vectors with Z flipped.
+	void convertMatrix(F32* _out, const ufbx_matrix& _mtx)
+	{
+		for (U32 i = 0; i < 4; i++)
+		{
+			_out[i * 4 + 0] = (F32)_mtx.cols[i].x;
+			_out[i * 4 + 1] = (F32)_mtx.cols[i].y;
+			_out[i * 4 + 2] = (F32)-_mtx.cols[i].z;
+			_out[i * 4 + 3] = i == 3 ? 1.0f : 0.0f;
+		}
+	}
+
+	// Collects the nodes below the scene root in breadth-first order. Transforms get the same Z flip as
+	// matrices, which mirrors the translation and rotation of every node but keeps its scale.
+	void collectNodes(std::vector<compiler::PrefabNode>& _nodes, std::vector<U32>& _nodeIndices, const ufbx_scene* _scene)
+	{
+		_nodeIndices.assign(_scene->nodes.count, pakx::kInvalidIndex);
+
+		std::vector<const ufbx_node*> queue(_scene->root_node->children.begin(), _scene->root_node->children.end());
+		for (U32 i = 0; i < queue.size(); i++)
+		{
+			const ufbx_node* node = queue[i];
+			_nodeIndices[node->typed_id] = i;
+
+			const ufbx_transform& local = node->local_transform;
+			compiler::PrefabNode prefabNode;
+			prefabNode.parent = node->parent->is_root ? pakx::kInvalidIndex : _nodeIndices[node->parent->typed_id];
+			prefabNode.translation[0] = (F32)local.translation.x;
+			prefabNode.translation[1] = (F32)local.translation.y;
+			prefabNode.translation[2] = (F32)-local.translation.z;
+			prefabNode.rotation[0] = (F32)-local.rotation.x;
+			prefabNode.rotation[1] = (F32)-local.rotation.y;
+			prefabNode.rotation[2] = (F32)local.rotation.z;
+			prefabNode.rotation[3] = (F32)local.rotation.w;
+			prefabNode.scale[0] = (F32)local.scale.x;
+			prefabNode.scale[1] = (F32)local.scale.y;
+			prefabNode.scale[2] = (F32)local.scale.z;
+			_nodes.push_back(prefabNode);
+
+			queue.insert(queue.end(), node->children.begin(), node->children.end());
+		}
+	}
+
+	// Finds the LOD group a node is a level of, the level is the group child the node sits under.
+	const ufbx_node* findLodGroup(const ufbx_node* _node, U32& _level)
+	{
+		for (const ufbx_node* child = _node; NULL != child->parent; child = child->parent)
+		{
+			const ufbx_node* parent = child->parent;
+			if (parent->attrib_type != UFBX_ELEMENT_LOD_GROUP)
+			{
+				continue;
+			}
+
+			for (U32 i = 0; i < parent->children.count; i++)
+			{
+				if (parent->children.data[i] == child)
+				{
+					_level = i;
+					return parent;
+				}
+			}
+		}
+
+		return NULL;
+	}
+
+	// Corners weld by value. Meshes with blend shapes also weld by FBX vertex, corners of different FBX
+	// vertices may match but move apart under a blend shape.
+	struct WeldKey
+	{
+		MeshVertex vertex;
+		U32 source;
+
+		bool operator==(const WeldKey& _other) const
+		{
+			return vertex == _other.vertex && source == _other.source;
+		}
+	};
+
+	struct WeldKeyHash
+	{
+		size_t operator()(const WeldKey& _key) const
+		{
+			return compiler::MeshVertexHash()(_key.vertex) ^ (_key.source * 0x9e3779b9u);
+		}
+	};
+
+	mara::ResourceHandle importScene(const base::FilePath& _fbxPath, 
+		const base::FilePath& _outVfp, bool _isStatic)
+	{
+		compiler::BuildAssetScope asset(s_report, _fbxPath.getCPtr(), "scene");
+
+		// Load FBX from memory, parser allocations come from arenas that are dropped as a whole
+		ufbx_scene* scene = NULL;
+		compiler::ArenaAllocator resultArena;
+		{
+			compiler::BuildStageScope stage(s_report, compiler::BuildStage::Parse);
+
+			compiler::ArenaAllocator tempArena;
+			ufbx_error err;
+			scene = compiler::loadFbx(_fbxPath.getCPtr(), s_sourceFiles, tempArena, resultArena, &err);
+
+			const compiler::SourceFile* file = s_sourceFiles.load(_fbxPath.getCPtr());
+			s_report.getAsset()->inputBytes += NULL != file ? file->size : 0;
+			s_report.getAsset()->numParseAllocations += tempArena.getNumAllocations() + resultArena.getNumAllocations();
+			s_report.getAsset()->parseBytes += tempArena.getPeakBytes() + resultArena.getPeakBytes();
+		}
 		if (!scene)
 		{
 			BASE_TRACE("Failed to load fbx file at %s", _fbxPath.getCPtr())
 			return MARA_INVALID_HANDLE;
 		}
 		
+		std::vector<compiler::SceneMesh> sceneMeshes;
 		std::vector<std::string> meshes;
+		std::vector<pakx::Mesh> meshRecords;
 
 		// Load Scene
 		mara::ResourceHandle resource = MARA_INVALID_HANDLE;
 
+		// Meshes are placed by their node, so instances can move parts of the prefab on their own
+		std::vector<compiler::PrefabNode> nodes;
+		std::vector<U32> nodeIndices; // Prefab node of every scene node
+		collectNodes(nodes, nodeIndices, scene);
+
+		// Scratch buffers reused by every mesh, they only grow to the largest mesh of the scene
+		std::vector<U32> triIndices;
+		std::vector<MeshVertex> corners;
+		std::vector<U32> cornerSources; // FBX vertex of each corner
+		std::unordered_map<WeldKey, U32, WeldKeyHash> weldLookup; // Unique vertex of each distinct corner
+
+		// Settings, materials and shaders, the runtime keeps a prefab's engine prefabs while this and the
+		// sources stay the same
+		base::HashMurmur2A outputHash;
+		outputHash.begin();
+		outputHash.add(s_settings.hashOutput());
+
 		U32 meshId = 0;
 		for (size_t i = 0; i < scene->nodes.count; i++)
 		{
-			// Create a data structure to hold unique vertices and indices.
-			std::vector<MeshVertex>* uniqueVertices = new std::vector<MeshVertex>();
-			std::vector<U16>* indices = new std::vector<U16>();
-
 			// Get node
 			ufbx_node* node = scene->nodes.data[i];
 			if (node->is_root) continue;
@@ -142,62 +860,136 @@ namespace
 			// Handle Mesh
 			if (node->mesh)
 			{
-				const size_t maxExpectedVertices = scene->nodes.count * node->mesh->max_face_triangles * 3;
-				uniqueVertices->reserve(maxExpectedVertices);
-				indices->reserve(maxExpectedVertices);
+				const size_t numCorners = node->mesh->num_triangles * 3;
+				triIndices.resize(node->mesh->max_face_triangles * 3);
+				corners.clear();
+				corners.reserve(numCorners);
+				cornerSources.clear();
+				cornerSources.reserve(numCorners);
 
-				// Load geometry
-				for (U32 j = 0; j < node->mesh->faces.count; j++)
+				// Unique vertices end up at most as many as the FBX vertices, split seams aside
+				std::vector<MeshVertex> uniqueVertices;
+				std::vector<U32> indices;
+				uniqueVertices.reserve(node->mesh->num_vertices);
+				indices.reserve(numCorners);
+
+				// Triangulate faces into one vertex per triangle corner
 				{
-					ufbx_face face = node->mesh->faces.data[j];
+					compiler::BuildStageScope stage(s_report, compiler::BuildStage::Triangulate);
+					for (U32 j = 0; j < node->mesh->faces.count; j++)
+					{
+						ufbx_face face = node->mesh->faces.data[j];
 
-					// Triangulate the face
-					std::vector<U32> triIndices;
-					triIndices.resize(node->mesh->max_face_triangles * 3);
-					U32 numTris = ufbx_triangulate_face(triIndices.data(), triIndices.size(), node->mesh, face);
+						// Triangulate the face
+						U32 numTris = ufbx_triangulate_face(triIndices.data(), triIndices.size(), node->mesh, face);
 
-					for (U32 k = 0; k < numTris; k++)
-					{
-						for (U32 l = 0; l < 3; l++)
+						for (U32 k = 0; k < numTris; k++)
 						{
-							U16 index = triIndices[k * 3 + l];
+							for (U32 l = 0; l < 3; l++)
+							{
+								const U32 index = triIndices[k * 3 + l];
 
-							MeshVertex vertex;
+								MeshVertex vertex = {};
 
-							vertex.x = (F32)node->mesh->vertex_position[index].x;
-							vertex.y = (F32)node->mesh->vertex_position[index].y;
-							vertex.z = (F32)node->mesh->vertex_position[index].z;
+								vertex.x = (F32)node->mesh->vertex_position[index].x;
+								vertex.y = (F32)node->mesh->vertex_position[index].y;
+								vertex.z = (F32)node->mesh->vertex_position[index].z;
 
-							if (node->mesh->vertex_uv.exists)
-							{
-								vertex.u = (F32)node->mesh->vertex_uv.values[node->mesh->vertex_uv.indices[index]].x;
-								vertex.v = (F32)node->mesh->vertex_uv.values[node->mesh->vertex_uv.indices[index]].y;
-							}
+								if (node->mesh->vertex_uv.exists)
+								{
+									vertex.u = (F32)node->mesh->vertex_uv.values[node->mesh->vertex_uv.indices[index]].x;
+									vertex.v = (F32)node->mesh->vertex_uv.values[node->mesh->vertex_uv.indices[index]].y;
+								}
 
-							if (node->mesh->vertex_normal.exists)
-							{
-								vertex.nx = (F32)node->mesh->vertex_normal.values[node->mesh->vertex_normal.indices[index]].x;
-								vertex.ny = (F32)node->mesh->vertex_normal.values[node->mesh->vertex_normal.indices[index]].y;
-								vertex.nz = (F32)node->mesh->vertex_normal.values[node->mesh->vertex_normal.indices[index]].z;
-							}
+								if (node->mesh->vertex_normal.exists)
+								{
+									vertex.nx = (F32)node->mesh->vertex_normal.values[node->mesh->vertex_normal.indices[index]].x;
+									vertex.ny = (F32)node->mesh->vertex_normal.values[node->mesh->vertex_normal.indices[index]].y;
+									vertex.nz = (F32)node->mesh->vertex_normal.values[node->mesh->vertex_normal.indices[index]].z;
+								}
 
-							auto it = std::find(uniqueVertices->begin(), uniqueVertices->end(), vertex);
-							if (it == uniqueVertices->end())
-							{
-								uniqueVertices->push_back(vertex);
-								indices->push_back(static_cast<U16>(uniqueVertices->size() - 1));
+								corners.push_back(vertex);
+								cornerSources.push_back(node->mesh->vertex_indices[index]);
 							}
-							else
+						}
+					}
+				}
+
+				// Weld identical corners into unique vertices
+				std::vector<U32> sourceVertices;
+				sourceVertices.reserve(node->mesh->num_vertices);
+				{
+					compiler::BuildStageScope stage(s_report, compiler::BuildStage::Weld);
+
+					// Cleared keeps the buckets of earlier meshes
+					weldLookup.clear();
+					weldLookup.reserve(node->mesh->num_vertices);
+					const bool isBlended = node->mesh->blend_deformers.count > 0;
+					for (U32 j = 0; j < corners.size(); j++)
+					{
+						const MeshVertex& vertex = corners[j];
+						const WeldKey key = { vertex, isBlended ? cornerSources[j] : 0 };
+						auto it = weldLookup.emplace(key, (U32)uniqueVertices.size());
+						if (it.second)
+						{
+							uniqueVertices.push_back(vertex);
+							sourceVertices.push_back(cornerSources[j]);
+						}
+						indices.push_back(it.first->second);
+					}
+
+					s_report.getAsset()->numSourceVertices += (U32)corners.size();
+					s_report.getAsset()->numWeldedVertices += (U32)uniqueVertices.size();
+				}
+
+				// Load blend shapes, each channel uses its full weight shape
+				std::vector<compiler::MorphTarget> morphTargets;
+				for (const ufbx_blend_deformer* deformer : node->mesh->blend_deformers)
+				{
+					for (const ufbx_blend_channel* channel : deformer->channels)
+					{
+						if (channel->keyframes.count == 0)
+						{
+							continue;
+						}
+
+						const ufbx_blend_shape* shape = channel->keyframes.data[channel->keyframes.count - 1].shape;
+
+						compiler::MorphTarget target;
+						target.name = channel->name.data;
+						for (size_t j = 0; j < shape->num_offsets; j++)
+						{
+							// Offsets may point past the vertices of this mesh
+							const U32 sourceVertex = shape->offset_vertices.data[j];
+							if (sourceVertex >= node->mesh->num_vertices)
 							{
-								indices->push_back(static_cast<U16>(it - uniqueVertices->begin()));
+								continue;
 							}
+
+							const ufbx_vec3 offset = shape->position_offsets.data[j];
+							target.sourceVertices.push_back(sourceVertex);
+							target.offsets.push_back({ (F32)offset.x, (F32)offset.y, (F32)offset.z });
 						}
+						morphTargets.push_back(target);
 					}
 				}
+				const bool hasMorphTargets = !morphTargets.empty();
 
 				// Load material
+				U32 texture = pakx::kInvalidIndex;
+				U32 textureArray = pakx::kInvalidIndex;
+				bool isTextured = false;
 				mara::MaterialParameters parameters;
 
+				// Uniforms go into one packed block per material instead of separate parameters
+				pakx::MaterialBlock block;
+				base::memSet(&block, 0, sizeof(block));
+				block.diffuse[0] = 1.0f;
+				block.diffuse[1] = 1.0f;
+				block.diffuse[2] = 1.0f;
+				block.diffuse[3] = 1.0f;
+				block.alphaCutoff = 0.5f;
+
 				ufbx_material* mat = node->materials[0];
 				for (U32 j = 0; j < mat->textures.count; j++)
 				{
@@ -213,131 +1005,364 @@ namespace
 						continue;
 					}
 						
-					ufbx_string pathToTexture = mat->textures[j].texture->absolute_filename;
-					ufbx_string virtualPathToTexture = mat->textures[j].texture->relative_filename; // @todo Find more unique path
-
-					base::FilePath texturePath = "textures";
-					texturePath.join(base::FilePath(mat->textures[j].texture->relative_filename.data).getBaseName());
-					texturePath.join(".bin", false);
-
-					mara::ResourceHandle texture = importTexture(pathToTexture.data, texturePath);
-					parameters.addTexture(parameterMara, texture, 0);
+					// Streamed textures are bound by the runtime texture streamer, not the material
+					const TextureCache::Entry* cached = s_textureCache.import(mat->textures[j].texture->absolute_filename.data);
+					if (NULL != cached)
+					{
+						isTextured = true;
+						if (cached->arrayIndex != pakx::kInvalidIndex)
+						{
+							textureArray = cached->arrayIndex;
+							block.textureLayer = (F32)cached->arrayLayer;
+						}
+						else if (cached->streamIndex != pakx::kInvalidIndex)
+						{
+							texture = cached->streamIndex;
+						}
+						else
+						{
+							parameters.addTexture(parameterMara, cached->handle, 0);
+						}
+					}
 				}
 				for (U32 j = 0; j < mat->props.props.count; j++)
 				{
 					// Load material properties
 					ufbx_prop prop = mat->props.props[j];
 					ufbx_string parameter = prop.name;
-					const char* parameterMara = NULL;
-					if (base::strCmp(parameter.data, "Maya|baseColor") == 0)
-					{
-						parameterMara = "u_diffuse";
-					}
-					else
+					if (base::strCmp(parameter.data, "Maya|baseColor") != 0)
 					{
 						continue;
 					}
 
 					ufbx_vec3 colorFbx = prop.value_vec3;
-					F32 color[4] = { (F32)colorFbx.x, (F32)colorFbx.y, (F32)colorFbx.z, 1.0f };
-					parameters.addVec4(parameterMara, color);
+					block.diffuse[0] = (F32)colorFbx.x;
+					block.diffuse[1] = (F32)colorFbx.y;
+					block.diffuse[2] = (F32)colorFbx.z;
 				}
 
-				// Create Geometry Resource
-				base::FilePath geometryPath = base::FilePath("geometry");
+				// Create Material Resource, the shader variant samples the texture or uses the constant color
+				base::FilePath materialPath = base::FilePath("material");
+				U16 program = 0;
 				{
-					graphics::VertexLayout layout;
-					layout.begin()
-						.add(graphics::Attrib::Position, 3, graphics::AttribType::Float)
-						.add(graphics::Attrib::TexCoord0, 2, graphics::AttribType::Float)
-						.add(graphics::Attrib::Normal, 3, graphics::AttribType::Float)
-						.end();
-
-					mara::GeometryCreate geometry;
-					geometry.vertices = uniqueVertices->data();
-					geometry.verticesSize = uniqueVertices->size() * sizeof(MeshVertex);
-					geometry.indices = indices->data();
-					geometry.indicesSize = indices->size() * sizeof(U16);
-					geometry.layout = layout;
+					const char* vertShaderPath = "shaders/vs_cube.bin";
+					const char* fragShaderPath = isTextured ? "shaders/fs_cube_textured.bin" : "shaders/fs_cube.bin";
+					if (s_settings.textureArrays)
+					{
+						// Meshes are drawn instanced and sample their layer of the bound array
+						vertShaderPath = "shaders/vs_cube_instanced.bin";
+						fragShaderPath = isTextured ? "shaders/fs_cube_textured_texture_array.bin" : "shaders/fs_cube.bin";
+					}
 
+					// Morphed meshes are drawn one at a time with their own deltas
+					if (hasMorphTargets)
 					{
-						U32 hash = base::hash<base::HashMurmur2A>(geometry.vertices, geometry.verticesSize);
-						std::string hashAsString = std::to_string(hash);
-						geometryPath.join(hashAsString.c_str());
+						vertShaderPath = "shaders/vs_cube_morph.bin";
 					}
-					geometryPath.join(".bin", false);
-					mara::createResource(geometry, geometryPath);
-				}
 
-				// Create Material Resource
-				base::FilePath materialPath = base::FilePath("material");
-				{
 					mara::MaterialCreate material;
-					material.vertShaderPath = "shaders/vs_cube.bin";
-					material.fragShaderPath = "shaders/fs_cube.bin";
+					material.vertShaderPath = vertShaderPath;
+					material.fragShaderPath = fragShaderPath;
+					program = s_programTable.addProgram(vertShaderPath, fragShaderPath);
 					material.parameters = parameters;
 
+					outputHash.add(block);
+					for (const char* shaderPath : { vertShaderPath, fragShaderPath })
+					{
+						outputHash.add(shaderPath, base::strLen(shaderPath));
+						const std::vector<U8>* bytecode = s_shaders.findBytecode(shaderPath);
+						if (NULL != bytecode)
+						{
+							outputHash.add(bytecode->data(), (I32)bytecode->size());
+						}
+					}
+
+					// Material names are only unique within a scene, e.g. every Maya scene has a lambert1
+					materialPath.join(_outVfp.getPath());
+					materialPath.join(_outVfp.getBaseName());
 					materialPath.join(mat->name.data);
+					if (hasMorphTargets)
+					{
+						materialPath.join("_morph", false);
+					}
 					materialPath.join(".bin", false);
-					mara::createResource(material, materialPath);
+					{
+						compiler::BuildStageScope stage(s_report, compiler::BuildStage::Write);
+						mara::createResource(material, materialPath);
+					}
+					s_resourceTable.addResource(materialPath, pakx::ResourceType::Material, sizeof(mara::MaterialCreate), sizeof(pakx::MaterialBlock));
 				}
+				const U32 materialIndex = s_materialTable.addMaterial(materialPath, block);
 
-				// Create Mesh Resource
-				base::FilePath meshPath = base::FilePath("meshes");
+				// Collect mesh, geometry is written once all nodes are known so static ones can be merged
+				compiler::SceneMesh sceneMesh;
+				sceneMesh.name = node->name.data;
+				sceneMesh.vertices.swap(uniqueVertices);
+				sceneMesh.indices.swap(indices);
+				sceneMesh.materialPath = materialPath.getCPtr();
+				sceneMesh.texture = texture;
+				sceneMesh.textureArray = textureArray;
+				sceneMesh.program = program;
+				sceneMesh.material = materialIndex;
+				sceneMesh.lodGroup = pakx::kInvalidIndex;
+				sceneMesh.lodLevel = 0;
+				sceneMesh.lodThreshold = 0.0f;
 				{
-					mara::MeshCreate mesh;
-					mesh.geometryPath = geometryPath;
-					mesh.materialPath = materialPath;
-
-					ufbx_matrix mtx = node->node_to_world;
-					ufbx_vec3 col0 = mtx.cols[0];
-					ufbx_vec3 col1 = mtx.cols[1];
-					ufbx_vec3 col2 = mtx.cols[2];
-					ufbx_vec3 col3 = mtx.cols[3];
-					mesh.m_transform[0] = col0.x;
-					mesh.m_transform[1] = col0.y;
-					mesh.m_transform[2] = -col0.z;
-					mesh.m_transform[3] = 0.0f;
-					mesh.m_transform[4] = col1.x;
-					mesh.m_transform[5] = col1.y;
-					mesh.m_transform[6] = -col1.z;
-					mesh.m_transform[7] = 0.0f;
-					mesh.m_transform[8] = col2.x;
-					mesh.m_transform[9] = col2.y;
-					mesh.m_transform[10] = -col2.z;
-					mesh.m_transform[11] = 0.0f;
-					mesh.m_transform[12] = col3.x;
-					mesh.m_transform[13] = col3.y;
-					mesh.m_transform[14] = -col3.z;
-					mesh.m_transform[15] = 1.0f;
-
-					meshPath.join(node->name.data);
-					meshPath.join(".bin", false);
-					mara::createResource(mesh, meshPath);
+					U32 level = 0;
+					const ufbx_node* groupNode = findLodGroup(node, level);
+					if (NULL != groupNode)
+					{
+						const ufbx_lod_group* group = (const ufbx_lod_group*)groupNode->attrib;
+						sceneMesh.lodGroup = groupNode->typed_id;
+						sceneMesh.lodLevel = level;
+						if (group->lod_levels.count > 0)
+						{
+							sceneMesh.lodThreshold = (F32)group->lod_levels.data[base::min(level, (U32)group->lod_levels.count - 1)].distance;
+						}
+					}
+				}
+				if (hasMorphTargets)
+				{
+					sceneMesh.sourceVertices.swap(sourceVertices);
+					sceneMesh.morphTargets.swap(morphTargets);
+				}
+				sceneMesh.node = nodeIndices[node->typed_id];
+				convertMatrix(sceneMesh.transform, node->geometry_to_world);
+				convertMatrix(sceneMesh.nodeTransform, node->geometry_to_node);
+
+				if (!sceneMesh.indices.empty())
+				{
+					sceneMeshes.push_back(std::move(sceneMesh));
 				}
 
-				meshes.push_back(meshPath.getCPtr());
 				meshId++;
 			}
 		}
 
-		// Create scene prefab
+		compiler::BuildStageScope encodeStage(s_report, compiler::BuildStage::Encode);
+
+		// Merge static meshes sharing a material into spatially bucketed batches, morphed meshes and LOD
+		// group levels stay apart
+		if (_isStatic && s_settings.mergeStaticMeshes)
+		{
+			std::vector<compiler::SceneMesh> mergeable;
+			std::vector<compiler::SceneMesh> batches;
+			for (compiler::SceneMesh& sceneMesh : sceneMeshes)
+			{
+				if (sceneMesh.morphTargets.empty() && sceneMesh.lodGroup == pakx::kInvalidIndex)
+				{
+					mergeable.push_back(std::move(sceneMesh));
+				}
+				else
+				{
+					batches.push_back(std::move(sceneMesh));
+				}
+			}
+
+			const U32 numKept = (U32)batches.size();
+			compiler::batchStaticMeshes(batches, mergeable, s_settings.batchMaxVertices, s_settings.batchMaxExtent);
+			BASE_TRACE("Batched %s: %d meshes -> %d batches", _outVfp.getCPtr(), (U32)mergeable.size(), (U32)batches.size() - numKept)
+			sceneMeshes.swap(batches);
+		}
+
+		// Geometry indices are 16 bit, larger meshes are written as several
+		{
+			const U32 numMeshes = (U32)sceneMeshes.size();
+			compiler::splitLargeMeshes(sceneMeshes, UINT16_MAX);
+			if (sceneMeshes.size() != numMeshes)
+			{
+				BASE_TRACE("Split %s: %d meshes -> %d to fit 16 bit indices", _outVfp.getCPtr(), numMeshes, (U32)sceneMeshes.size())
+			}
+		}
+
+		std::vector<U32> writtenLodGroups;
+		for (const compiler::SceneMesh& sceneMesh : sceneMeshes)
 		{
-			mara::PrefabCreate prefab;
+			if (sceneMesh.lodGroup == pakx::kInvalidIndex)
+			{
+				createMesh(sceneMesh, meshes, meshRecords);
+				continue;
+			}
 
-			prefab.m_numMeshes = meshes.size();
-			for (U32 i = 0; i < meshes.size(); i++)
+			// Every level of a group is written when its first mesh comes up
+			if (std::find(writtenLodGroups.begin(), writtenLodGroups.end(), sceneMesh.lodGroup) != writtenLodGroups.end())
 			{
-				prefab.meshPaths[i] = meshes[i].c_str();
+				continue;
 			}
+			writtenLodGroups.push_back(sceneMesh.lodGroup);
 
-			resource = mara::createResource(prefab, _outVfp);
+			const ufbx_node* groupNode = scene->nodes.data[sceneMesh.lodGroup];
+			std::vector<std::vector<const compiler::SceneMesh*> > levels(groupNode->children.count);
+			for (const compiler::SceneMesh& other : sceneMeshes)
+			{
+				if (other.lodGroup == sceneMesh.lodGroup)
+				{
+					levels[other.lodLevel].push_back(&other);
+				}
+			}
+
+			// A level is one mesh record, groups with split levels or gaps keep their most detailed level only
+			std::vector<const compiler::SceneMesh*> chain;
+			for (const std::vector<const compiler::SceneMesh*>& level : levels)
+			{
+				if (level.size() != 1)
+				{
+					break;
+				}
+				chain.push_back(level[0]);
+			}
+
+			if (chain.size() == levels.size())
+			{
+				const ufbx_lod_group* group = (const ufbx_lod_group*)groupNode->attrib;
+				createLodGroup(chain, group->relative_distances, meshes, meshRecords);
+			}
+			else
+			{
+				BASE_TRACE("LOD group %s has levels with none or several meshes, keeping level 0 only", groupNode->name.data)
+				for (const compiler::SceneMesh* mesh : levels[0])
+				{
+					createMesh(*mesh, meshes, meshRecords);
+				}
+			}
 		}
 
+		// Create scene prefab, meshes that don't fit in one engine prefab go to further parts
+		{
+			static_assert(pakx::kMaxPartMeshes <= BASE_COUNTOF(mara::PrefabCreate().meshPaths), "Prefab part too large");
+			compiler::BuildStageScope stage(s_report, compiler::BuildStage::Write);
+
+			const U32 numParts = base::max<U32>(((U32)meshes.size() + pakx::kMaxPartMeshes - 1) / pakx::kMaxPartMeshes, 1);
+			for (U32 part = 0; part < numParts; part++)
+			{
+				char partPath[256];
+				pakx::getPartPath(partPath, sizeof(partPath), _outVfp.getCPtr(), part);
+				const base::FilePath vfp = part == 0 ? _outVfp : base::FilePath(partPath);
+
+				mara::PrefabCreate prefab;
+				const U32 firstMesh = part * pakx::kMaxPartMeshes;
+				prefab.m_numMeshes = base::min<U32>((U32)meshes.size() - firstMesh, pakx::kMaxPartMeshes);
+				for (U32 i = 0; i < prefab.m_numMeshes; i++)
+				{
+					prefab.meshPaths[i] = meshes[firstMesh + i].c_str();
+				}
+
+				const mara::ResourceHandle handle = mara::createResource(prefab, vfp);
+				resource = part == 0 ? handle : resource;
+				s_resourceTable.addResource(vfp, pakx::ResourceType::Prefab, sizeof(mara::PrefabCreate), 0);
+			}
+
+			// FBX and every texture read for it are still in the source cache
+			outputHash.add(s_sourceFiles.hashContents());
+			s_prefabTable.addPrefab(_outVfp, meshRecords, numParts, nodes, outputHash.end());
+		}
+
+		// Scene memory goes with the result arena, source files aren't shared across scenes
 		ufbx_free_scene(scene);
+		s_sourceFiles.clear();
 		return resource;
 	}
 
+#if COMPILER_CONFIG_BENCHMARK
+	// Imports the bundled FBX files and generated meshes and textures of growing size, then packs all of
+	// it. Generated inputs are written next to the PAK and reused by later runs of the same size.
+	void runBenchmark(I32 _argc, const char* const* _argv)
+	{
+		// Larger grids take minutes each, pass --max-triangles to go further
+		U32 maxTriangles = 1000000;
+		U32 maxTextureSize = 8192;
+		for (I32 i = 1; i + 1 < _argc; i++)
+		{
+			if (0 == std::strcmp(_argv[i], "--max-triangles"))
+			{
+				maxTriangles = (U32)std::strtoul(_argv[i + 1], NULL, 10);
+			}
+			else if (0 == std::strcmp(_argv[i], "--max-texture"))
+			{
+				maxTextureSize = (U32)std::strtoul(_argv[i + 1], NULL, 10);
+			}
+		}
+
+		compiler::ThroughputBenchmark benchmark(s_report);
+
+		static const char* kBundledScenes[][2] =
+		{
+			{ "characters/character.fbx", "benchmark/character.bin" },
+			{ "characters/resources/X Bot.fbx", "benchmark/xbot.bin" },
+		};
+		for (U32 i = 0; i < BASE_COUNTOF(kBundledScenes); i++)
+		{
+			const std::string path = resourcePath(kBundledScenes[i][0]);
+			benchmark.begin(path.c_str(), "scene");
+			importScene(path.c_str(), kBundledScenes[i][1], false);
+			benchmark.end();
+		}
+
+		for (U32 numTriangles = 1000; numTriangles <= maxTriangles; numTriangles *= 10)
+		{
+			char path[256];
+			char vfp[256];
+			base::snprintf(path, sizeof(path), "%sbenchmark_grid_%u.obj", s_paths.output.c_str(), numTriangles);
+			base::snprintf(vfp, sizeof(vfp), "benchmark/grid_%u.bin", numTriangles);
+
+			base::FileReader reader;
+			base::Error err;
+			if (!base::open(&reader, path, &err) && !compiler::writeGridMesh(path, numTriangles))
+			{
+				continue;
+			}
+			base::close(&reader);
+
+			benchmark.begin(path, "mesh");
+			importScene(path, vfp, false);
+			benchmark.end();
+		}
+
+		for (U32 size = 256; size <= maxTextureSize; size *= 2)
+		{
+			char path[256];
+			base::snprintf(path, sizeof(path), "%sbenchmark_noise_%u.tga", s_paths.output.c_str(), size);
+
+			base::FileReader reader;
+			base::Error err;
+			if (!base::open(&reader, path, &err) && !compiler::writeNoiseTexture(path, size))
+			{
+				continue;
+			}
+			base::close(&reader);
+
+			benchmark.begin(path, "texture");
+			s_textureCache.import(path);
+			benchmark.end();
+
+			// Textures outside of scenes stay mapped until the cache is cleared
+			s_sourceFiles.clear();
+		}
+
+		const std::string pakPath = outputPath("benchmark.pak");
+		{
+			benchmark.begin(pakPath.c_str(), "pak");
+			compiler::BuildAssetScope asset(s_report, pakPath.c_str(), "pak");
+			{
+				compiler::BuildStageScope stage(s_report, compiler::BuildStage::Write);
+				mara::createPak(pakPath.c_str());
+			}
+
+			base::FileReader reader;
+			base::Error err;
+			if (base::open(&reader, pakPath.c_str(), &err))
+			{
+				s_report.getAsset()->outputBytes += base::getSize(&reader);
+				base::close(&reader);
+			}
+		}
+		benchmark.end();
+
+		benchmark.writeJson(outputPath("benchmark_compiler.json").c_str());
+		benchmark.printSummary();
+	}
+#endif // COMPILER_CONFIG_BENCHMARK
+
 	class GameCompiler : public entry::AppI
 	{
 	public:
@@ -351,32 +1376,97 @@ namespace
 		{
 			// Init engine
 			mara::Init maraInit;
+#if COMPILER_CONFIG_BENCHMARK
+			maraInit.graphicsApi = graphics::RendererType::Noop;
+#else
 			maraInit.graphicsApi = graphics::RendererType::Direct3D11;
+#endif // COMPILER_CONFIG_BENCHMARK
 			maraInit.resolution.width = _width;
 			maraInit.resolution.height = _height;
 			if (mara::init(maraInit))
 			{
 				graphics::setViewClear(0, GRAPHICS_CLEAR_COLOR | GRAPHICS_CLEAR_DEPTH, 0xFF00FFFF, 1.0f, 0);
 			}
+			initPaths(_argc, _argv);
 
-			// Import shaders from sc
-			importShader(RESOURCE_LOCATION "vs_cube.sc", RESOURCE_LOCATION "varying.def.sc", graphics::ShaderType::Vertex,
-				"shaders/vs_cube.bin");
+#if COMPILER_CONFIG_BENCHMARK
+			// Benchmark replaces the build, the app quits on the first update
+			runBenchmark(_argc, _argv);
+			return;
+#endif // COMPILER_CONFIG_BENCHMARK
 
-			importShader(RESOURCE_LOCATION "fs_cube.sc", RESOURCE_LOCATION "varying.def.sc", graphics::ShaderType::Fragment,
-				"shaders/fs_cube.bin");
+			// Compile all shader variants from sc, the first profile is the one the demo loads
+			s_shaders.addProfile("dx11", "windows", "s_5_0");
+			s_shaders.addProfile("spirv", "linux", "spirv");
+			s_shaders.addProfile("glsl", "linux", "440");
+			s_shaders.addProfile("metal", "osx", "metal");
+
+			const std::string varyingPath = resourcePath("varying.def.sc");
+			s_shaders.addShader(resourcePath("vs_cube.sc").c_str(), varyingPath.c_str(), graphics::ShaderType::Vertex,
+				"vs_cube", { "INSTANCED", "MORPH" });
+			s_shaders.addShader(resourcePath("fs_cube.sc").c_str(), varyingPath.c_str(), graphics::ShaderType::Fragment,
+				"fs_cube", { "TEXTURED", "ALPHA_TEST", "TEXTURE_ARRAY" });
+
+			{
+				// Compiling and creating resources overlap, all of it counts as encoding
+				compiler::BuildAssetScope asset(s_report, resourcePath("*.sc").c_str(), "shaders");
+				compiler::BuildStageScope stage(s_report, compiler::BuildStage::Encode);
+
+				s_shaders.build(s_paths.shaderCache.c_str(), s_settings.shaderThreads);
+				BASE_TRACE("Shaders: %d compiled, %d from cache, %d failed", s_shaders.getNumCompiled(), s_shaders.getNumCached(),
+					s_shaders.getNumFailed())
+				for (const auto& it : s_shaders.getBytecode())
+				{
+					s_resourceTable.addResource(it.first.c_str(), pakx::ResourceType::Shader, (U32)it.second.size(), (U32)it.second.size());
+					s_report.getAsset()->outputBytes += it.second.size();
+				}
+				s_report.getAsset()->numCacheHits += s_shaders.getNumCached();
+			}
 
 			// Import character from fbx
-			importScene(RESOURCE_LOCATION "characters/character.fbx",
-				"characters/character.bin");
+			importScene(resourcePath("characters/character.fbx").c_str(),
+				"characters/character.bin", false);
 
 			// Import scene from fbx
-			importScene(RESOURCE_LOCATION "scenes/scene.fbx",
-				"scenes/scene.bin");
+			importScene(resourcePath("scenes/scene.fbx").c_str(),
+				"scenes/scene.bin", true);
+
+			BASE_TRACE("Textures: %d imported, %d reused from cache", s_textureCache.getNumMisses(), s_textureCache.getNumHits())
 
 			// Package all compiled resources into one big file
-			mara::createPak("C:/Users/marcu/Dev/mara-demo/demo/build/bin/data/assets.pak");
+			{
+				const std::string pakPath = outputPath("assets.pak");
+				compiler::BuildAssetScope asset(s_report, pakPath.c_str(), "pak");
+				compiler::BuildStageScope stage(s_report, compiler::BuildStage::Write);
+				mara::createPak(pakPath.c_str());
+			}
+
+			// Write data the PAK has no room for into the sidecar
+			compiler::PakxWriter writer;
+			writer.addChunk(pakx::kChunkTextures, s_textureStream.serialize());
+			writer.addChunk(pakx::kChunkPrefabs, s_prefabTable.serialize());
+			writer.addChunk(pakx::kChunkNodes, s_prefabTable.serializeNodes());
+			writer.addChunk(pakx::kChunkMeshlets, s_meshletTable.serialize());
+			writer.addChunk(pakx::kChunkPrograms, s_programTable.serialize(s_shaders));
+			writer.addChunk(pakx::kChunkMaterials, s_materialTable.serialize());
+			writer.addChunk(pakx::kChunkMorphs, s_morphTable.serialize());
+			if (s_settings.textureArrays)
+			{
+				// Presence of the chunk switches the runtime to instanced drawing
+				writer.addChunk(pakx::kChunkTextureArrays, s_textureArrays.serialize());
+			}
+			writer.addChunk(pakx::kChunkResources, s_resourceTable.serialize());
+			{
+				const std::string pakxPath = outputPath("assets.pakx");
+				compiler::BuildAssetScope asset(s_report, pakxPath.c_str(), "pakx");
+				compiler::BuildStageScope stage(s_report, compiler::BuildStage::Write);
+				writer.write(pakxPath.c_str());
+			}
 			BASE_TRACE("All assets are compiled and packed!")
+
+			// Slowest assets first
+			s_report.writeJson(outputPath("build_report.json").c_str());
+			s_report.printSummary(10);
 		}
 
 		int shutdown() override
@@ -388,6 +1478,10 @@ namespace
 
 		bool update() override
 		{
+#if COMPILER_CONFIG_BENCHMARK
+			return false;
+#endif // COMPILER_CONFIG_BENCHMARK
+
 			if (mara::update(GRAPHICS_DEBUG_TEXT, GRAPHICS_RESET_VSYNC))
 			{
 				// When this is called (aka: When the window becomes pink), all assets are compiled.
@@ -0,0 +1,320 @@
+#include "mesh_optimize.h"
+
+// std
+#include <algorithm>
+
+namespace compiler
+{
+	namespace
+	{
+		struct Adjacency
+		{
+			std::vector<U32> offsets; // Per vertex offset into triangles
+			std::vector<U32> counts;
+			std::vector<U32> triangles;
+		};
+
+		void buildAdjacency(Adjacency& _adjacency, const std::vector<U32>& _indices, U32 _numVertices)
+		{
+			_adjacency.offsets.assign(_numVertices, 0);
+			_adjacency.counts.assign(_numVertices, 0);
+			_adjacency.triangles.resize(_indices.size());
+
+			for (U32 index : _indices)
+			{
+				_adjacency.counts[index]++;
+			}
+
+			U32 offset = 0;
+			for (U32 i = 0; i < _numVertices; i++)
+			{
+				_adjacency.offsets[i] = offset;
+				offset += _adjacency.counts[i];
+			}
+
+			std::vector<U32> fill(_adjacency.offsets);
+			for (U32 i = 0; i < _indices.size(); i++)
+			{
+				_adjacency.triangles[fill[_indices[i]]++] = i / 3;
+			}
+		}
+
+		base::Vec3 getPosition(const MeshVertex& _vertex)
+		{
+			return { _vertex.x, _vertex.y, _vertex.z };
+		}
+
+	} // namespace
+
+	VertexCacheStats analyzeVertexCache(const std::vector<U32>& _indices, U32 _numVertices, U32 _cacheSize)
+	{
+		// Timestamp of when each vertex entered the FIFO
+		std::vector<U32> cacheTime(_numVertices, 0);
+		std::vector<bool> referenced(_numVertices, false);
+
+		U32 time = _cacheSize + 1;
+		U32 misses = 0;
+		U32 numReferenced = 0;
+		for (U32 index : _indices)
+		{
+			if (time - cacheTime[index] > _cacheSize)
+			{
+				cacheTime[index] = time++;
+				misses++;
+			}
+
+			if (!referenced[index])
+			{
+				referenced[index] = true;
+				numReferenced++;
+			}
+		}
+
+		VertexCacheStats stats;
+		stats.acmr = _indices.empty() ? 0.0f : F32(misses) / F32(_indices.size() / 3);
+		stats.atvr = numReferenced == 0 ? 0.0f : F32(misses) / F32(numReferenced);
+		return stats;
+	}
+
+	void optimizeVertexCache(std::vector<U32>& _indices, U32 _numVertices, U32 _cacheSize, std::vector<U32>* _outClusters)
+	{
+		const U32 numTriangles = (U32)_indices.size() / 3;
+		if (numTriangles == 0)
+		{
+			return;
+		}
+
+		Adjacency adjacency;
+		buildAdjacency(adjacency, _indices, _numVertices);
+
+		std::vector<U32> liveTriangles(adjacency.counts);
+		std::vector<U32> cacheTime(_numVertices, 0);
+		std::vector<bool> emitted(numTriangles, false);
+		std::vector<U32> deadEnd;
+		std::vector<U32> candidates;
+
+		std::vector<U32> result;
+		result.reserve(_indices.size());
+
+		U32 time = _cacheSize + 1;
+		U32 cursor = 0;
+
+		// Next fanning vertex when the local neighbourhood is exhausted: recently used vertices first,
+		// then the next vertex in input order that still has triangles.
+		auto skipDeadEnd = [&]() -> I32
+		{
+			while (!deadEnd.empty())
+			{
+				const U32 vertex = deadEnd.back();
+				deadEnd.pop_back();
+				if (liveTriangles[vertex] > 0)
+				{
+					return (I32)vertex;
+				}
+			}
+
+			while (cursor < _numVertices)
+			{
+				if (liveTriangles[cursor] > 0)
+				{
+					return (I32)cursor;
+				}
+				cursor++;
+			}
+
+			return -1;
+		};
+
+		I32 fanning = skipDeadEnd();
+		if (NULL != _outClusters)
+		{
+			_outClusters->push_back(0);
+		}
+
+		while (fanning >= 0)
+		{
+			candidates.clear();
+
+			// Emit all live triangles around the fanning vertex
+			const U32 begin = adjacency.offsets[fanning];
+			const U32 end = begin + adjacency.counts[fanning];
+			for (U32 i = begin; i < end; i++)
+			{
+				const U32 triangle = adjacency.triangles[i];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+
+				for (U32 j = 0; j < 3; j++)
+				{
+					const U32 vertex = _indices[triangle * 3 + j];
+					result.push_back(vertex);
+					deadEnd.push_back(vertex);
+					candidates.push_back(vertex);
+					liveTriangles[vertex]--;
+
+					if (time - cacheTime[vertex] > _cacheSize)
+					{
+						cacheTime[vertex] = time++;
+					}
+				}
+				emitted[triangle] = true;
+			}
+
+			// Pick the candidate that will still be in cache after emitting its remaining triangles,
+			// preferring the one that has been in cache the longest
+			I32 next = -1;
+			I32 bestPriority = -1;
+			for (U32 vertex : candidates)
+			{
+				if (liveTriangles[vertex] == 0)
+				{
+					continue;
+				}
+
+				I32 priority = 0;
+				if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= _cacheSize)
+				{
+					priority = (I32)(time - cacheTime[vertex]);
+				}
+
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					next = (I32)vertex;
+				}
+			}
+
+			if (next < 0)
+			{
+				next = skipDeadEnd();
+
+				if (NULL != _outClusters && next >= 0)
+				{
+					_outClusters->push_back((U32)result.size() / 3);
+				}
+			}
+
+			fanning = next;
+		}
+
+		_indices.swap(result);
+	}
+
+	void optimizeOverdraw(std::vector<U32>& _indices, const std::vector<MeshVertex>& _vertices, const std::vector<U32>& _clusters,
+		U32 _minClusterTriangles)
+	{
+		const U32 numTriangles = (U32)_indices.size() / 3;
+		if (numTriangles == 0 || _clusters.empty())
+		{
+			return;
+		}
+
+		// Merge small clusters, tiny clusters would break up the vertex cache order for nothing
+		std::vector<U32> clusters;
+		for (U32 i = 0; i < _clusters.size(); i++)
+		{
+			if (clusters.empty() || _clusters[i] - clusters.back() >= _minClusterTriangles)
+			{
+				clusters.push_back(_clusters[i]);
+			}
+		}
+		clusters.push_back(numTriangles);
+
+		// Area weighted centroid and normal per cluster
+		struct Cluster
+		{
+			U32 begin;
+			U32 end;
+			base::Vec3 centroid;
+			base::Vec3 normal;
+			F32 sortKey;
+		};
+
+		std::vector<Cluster> sorted(clusters.size() - 1);
+		base::Vec3 meshCentroid = { 0.0f, 0.0f, 0.0f };
+		F32 meshArea = 0.0f;
+		for (U32 i = 0; i < sorted.size(); i++)
+		{
+			Cluster& cluster = sorted[i];
+			cluster.begin = clusters[i];
+			cluster.end = clusters[i + 1];
+			cluster.centroid = { 0.0f, 0.0f, 0.0f };
+			cluster.normal = { 0.0f, 0.0f, 0.0f };
+
+			F32 clusterArea = 0.0f;
+			for (U32 triangle = cluster.begin; triangle < cluster.end; triangle++)
+			{
+				const base::Vec3 p0 = getPosition(_vertices[_indices[triangle * 3 + 0]]);
+				const base::Vec3 p1 = getPosition(_vertices[_indices[triangle * 3 + 1]]);
+				const base::Vec3 p2 = getPosition(_vertices[_indices[triangle * 3 + 2]]);
+
+				const base::Vec3 normal = base::cross(base::sub(p1, p0), base::sub(p2, p0));
+				const F32 area = base::length(normal);
+				const base::Vec3 centroid = base::mul(base::add(base::add(p0, p1), p2), 1.0f / 3.0f);
+
+				cluster.centroid = base::add(cluster.centroid, base::mul(centroid, area));
+				cluster.normal = base::add(cluster.normal, normal);
+				clusterArea += area;
+			}
+
+			meshCentroid = base::add(meshCentroid, cluster.centroid);
+			meshArea += clusterArea;
+			cluster.centroid = clusterArea > 0.0f ? base::mul(cluster.centroid, 1.0f / clusterArea) : cluster.centroid;
+		}
+		meshCentroid = meshArea > 0.0f ? base::mul(meshCentroid, 1.0f / meshArea) : meshCentroid;
+
+		// Clusters facing away from the center are likely to occlude the rest of the mesh
+		for (Cluster& cluster : sorted)
+		{
+			const F32 length = base::length(cluster.normal);
+			const base::Vec3 normal = length > 0.0f ? base::mul(cluster.normal, 1.0f / length) : cluster.normal;
+			cluster.sortKey = base::dot(base::sub(cluster.centroid, meshCentroid), normal);
+		}
+
+		std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& _a, const Cluster& _b)
+		{
+			return _a.sortKey > _b.sortKey;
+		});
+
+		std::vector<U32> result;
+		result.reserve(_indices.size());
+		for (const Cluster& cluster : sorted)
+		{
+			result.insert(result.end(), _indices.begin() + cluster.begin * 3, _indices.begin() + cluster.end * 3);
+		}
+
+		_indices.swap(result);
+	}
+
+	void optimizeVertexFetch(std::vector<MeshVertex>& _vertices, std::vector<U32>& _indices, std::vector<U32>* _outRemap)
+	{
+		const U32 kUnused = UINT32_MAX;
+		std::vector<U32> remap(_vertices.size(), kUnused);
+
+		std::vector<MeshVertex> result;
+		result.reserve(_vertices.size());
+		if (NULL != _outRemap)
+		{
+			_outRemap->clear();
+		}
+
+		for (U32& index : _indices)
+		{
+			if (remap[index] == kUnused)
+			{
+				remap[index] = (U32)result.size();
+				result.push_back(_vertices[index]);
+				if (NULL != _outRemap)
+				{
+					_outRemap->push_back(index);
+				}
+			}
+			index = remap[index];
+		}
+
+		_vertices.swap(result);
+	}
+
+} // namespace compiler
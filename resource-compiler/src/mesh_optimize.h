@@ -0,0 +1,33 @@
+#pragma once
+
+#include "geometry.h"
+
+// std
+#include <vector>
+
+namespace compiler
+{
+	struct VertexCacheStats
+	{
+		F32 acmr; // Average cache miss ratio, vertex shader invocations per triangle
+		F32 atvr; // Average transformed vertex ratio, vertex shader invocations per unique vertex
+	};
+
+	// Simulates a FIFO post-transform vertex cache of _cacheSize entries.
+	VertexCacheStats analyzeVertexCache(const std::vector<U32>& _indices, U32 _numVertices, U32 _cacheSize);
+
+	// Reorders triangles for post-transform vertex cache efficiency (Tipsify, Sander et al. 2007). When
+	// _outClusters is given it receives the first triangle of every cluster, clusters start where the
+	// algorithm had to jump to a new area of the mesh.
+	void optimizeVertexCache(std::vector<U32>& _indices, U32 _numVertices, U32 _cacheSize, std::vector<U32>* _outClusters);
+
+	// Reorders clusters so outward facing ones are drawn first, reducing overdraw while keeping the
+	// vertex cache order inside each cluster. Small clusters are merged up to _minClusterTriangles.
+	void optimizeOverdraw(std::vector<U32>& _indices, const std::vector<MeshVertex>& _vertices, const std::vector<U32>& _clusters,
+		U32 _minClusterTriangles);
+
+	// Reorders vertices in order of first use so vertex fetch walks memory linearly. When _outRemap is
+	// given it receives the previous index of every remaining vertex.
+	void optimizeVertexFetch(std::vector<MeshVertex>& _vertices, std::vector<U32>& _indices, std::vector<U32>* _outRemap);
+
+} // namespace compiler
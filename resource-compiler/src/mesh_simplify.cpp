@@ -0,0 +1,338 @@
+#include "mesh_simplify.h"
+
+// std
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+
+namespace compiler
+{
+	namespace
+	{
+		// Symmetric 4x4 matrix measuring squared distance to a set of planes, with the total plane weight
+		struct Quadric
+		{
+			F64 a00, a01, a02, a03;
+			F64 a11, a12, a13;
+			F64 a22, a23;
+			F64 a33;
+			F64 weight;
+		};
+
+		void quadricZero(Quadric& _q)
+		{
+			base::memSet(&_q, 0, sizeof(Quadric));
+		}
+
+		void quadricFromPlane(Quadric& _q, F64 _a, F64 _b, F64 _c, F64 _d, F64 _weight)
+		{
+			_q.a00 = _a * _a * _weight; _q.a01 = _a * _b * _weight; _q.a02 = _a * _c * _weight; _q.a03 = _a * _d * _weight;
+			_q.a11 = _b * _b * _weight; _q.a12 = _b * _c * _weight; _q.a13 = _b * _d * _weight;
+			_q.a22 = _c * _c * _weight; _q.a23 = _c * _d * _weight;
+			_q.a33 = _d * _d * _weight;
+			_q.weight = _weight;
+		}
+
+		void quadricAdd(Quadric& _q, const Quadric& _other)
+		{
+			_q.a00 += _other.a00; _q.a01 += _other.a01; _q.a02 += _other.a02; _q.a03 += _other.a03;
+			_q.a11 += _other.a11; _q.a12 += _other.a12; _q.a13 += _other.a13;
+			_q.a22 += _other.a22; _q.a23 += _other.a23;
+			_q.a33 += _other.a33;
+			_q.weight += _other.weight;
+		}
+
+		// Weighted mean of the squared plane distances, in mesh units squared whatever the weights
+		F64 quadricError(const Quadric& _q, const MeshVertex& _v)
+		{
+			if (_q.weight <= 0.0)
+			{
+				return 0.0;
+			}
+
+			const F64 x = _v.x, y = _v.y, z = _v.z;
+			const F64 error =
+				x * x * _q.a00 + 2.0 * x * y * _q.a01 + 2.0 * x * z * _q.a02 + 2.0 * x * _q.a03 +
+				y * y * _q.a11 + 2.0 * y * z * _q.a12 + 2.0 * y * _q.a13 +
+				z * z * _q.a22 + 2.0 * z * _q.a23 +
+				_q.a33;
+			return error > 0.0 ? error / _q.weight : 0.0;
+		}
+
+		base::Vec3 getPosition(const MeshVertex& _vertex)
+		{
+			return { _vertex.x, _vertex.y, _vertex.z };
+		}
+
+		struct Collapse
+		{
+			F64 cost;
+			U32 from;
+			U32 to;
+			U32 version;
+
+			bool operator>(const Collapse& _other) const
+			{
+				return cost > _other.cost;
+			}
+		};
+
+	} // namespace
+
+	F32 simplifyMesh(std::vector<U32>& _outIndices, const std::vector<MeshVertex>& _vertices, const std::vector<U32>& _indices,
+		U32 _targetIndexCount, F32 _maxError)
+	{
+		const U32 numVertices = (U32)_vertices.size();
+		const U32 numTriangles = (U32)_indices.size() / 3;
+
+		std::vector<U32> indices(_indices);
+
+		// Vertices sharing a position, more than one vertex per position means a UV or normal seam
+		std::vector<U32> positionId(numVertices);
+		std::vector<U32> positionCount;
+		{
+			struct PositionHash
+			{
+				size_t operator()(const base::Vec3& _p) const
+				{
+					return base::hash<base::HashMurmur2A>(&_p, sizeof(_p));
+				}
+			};
+			struct PositionEqual
+			{
+				bool operator()(const base::Vec3& _a, const base::Vec3& _b) const
+				{
+					return _a.x == _b.x && _a.y == _b.y && _a.z == _b.z;
+				}
+			};
+
+			std::unordered_map<base::Vec3, U32, PositionHash, PositionEqual> positions;
+			for (U32 i = 0; i < numVertices; i++)
+			{
+				auto it = positions.insert(std::make_pair(getPosition(_vertices[i]), (U32)positions.size())).first;
+				positionId[i] = it->second;
+			}
+
+			positionCount.assign(positions.size(), 0);
+			for (U32 i = 0; i < numVertices; i++)
+			{
+				positionCount[positionId[i]]++;
+			}
+		}
+
+		// Lock seam vertices and vertices on open borders
+		std::vector<bool> locked(numVertices, false);
+		{
+			std::unordered_map<U64, U32> edgeCount;
+			for (U32 i = 0; i < numTriangles; i++)
+			{
+				for (U32 j = 0; j < 3; j++)
+				{
+					U32 a = positionId[indices[i * 3 + j]];
+					U32 b = positionId[indices[i * 3 + (j + 1) % 3]];
+					if (a > b) std::swap(a, b);
+					edgeCount[((U64)a << 32) | b]++;
+				}
+			}
+
+			std::vector<bool> borderPosition(positionCount.size(), false);
+			for (const auto& edge : edgeCount)
+			{
+				if (edge.second == 1)
+				{
+					borderPosition[(U32)(edge.first >> 32)] = true;
+					borderPosition[(U32)(edge.first & 0xFFFFFFFF)] = true;
+				}
+			}
+
+			for (U32 i = 0; i < numVertices; i++)
+			{
+				locked[i] = positionCount[positionId[i]] > 1 || borderPosition[positionId[i]];
+			}
+		}
+
+		// Area weighted plane quadrics and vertex to triangle adjacency
+		std::vector<Quadric> quadrics(numVertices);
+		std::vector<std::vector<U32> > vertexTriangles(numVertices);
+		for (Quadric& quadric : quadrics)
+		{
+			quadricZero(quadric);
+		}
+		for (U32 i = 0; i < numTriangles; i++)
+		{
+			const base::Vec3 p0 = getPosition(_vertices[indices[i * 3 + 0]]);
+			const base::Vec3 p1 = getPosition(_vertices[indices[i * 3 + 1]]);
+			const base::Vec3 p2 = getPosition(_vertices[indices[i * 3 + 2]]);
+
+			const base::Vec3 normal = base::cross(base::sub(p1, p0), base::sub(p2, p0));
+			const F32 area = base::length(normal);
+			if (area > 0.0f)
+			{
+				const base::Vec3 n = base::mul(normal, 1.0f / area);
+
+				Quadric quadric;
+				quadricFromPlane(quadric, n.x, n.y, n.z, -base::dot(n, p0), area);
+				for (U32 j = 0; j < 3; j++)
+				{
+					quadricAdd(quadrics[indices[i * 3 + j]], quadric);
+				}
+			}
+
+			for (U32 j = 0; j < 3; j++)
+			{
+				vertexTriangles[indices[i * 3 + j]].push_back(i);
+			}
+		}
+
+		std::vector<U32> version(numVertices, 0);
+		std::vector<bool> alive(numVertices, true);
+		std::vector<bool> triangleAlive(numTriangles, true);
+
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse> > queue;
+		auto pushCollapses = [&](U32 _vertex)
+		{
+			for (U32 triangle : vertexTriangles[_vertex])
+			{
+				if (!triangleAlive[triangle])
+				{
+					continue;
+				}
+
+				for (U32 j = 0; j < 3; j++)
+				{
+					const U32 other = indices[triangle * 3 + j];
+					if (other == _vertex)
+					{
+						continue;
+					}
+
+					// Both directions, the cost only depends on the quadric of the collapsing vertex
+					if (!locked[_vertex])
+					{
+						Collapse collapse = { quadricError(quadrics[_vertex], _vertices[other]), _vertex, other, version[_vertex] };
+						queue.push(collapse);
+					}
+					if (!locked[other])
+					{
+						Collapse collapse = { quadricError(quadrics[other], _vertices[_vertex]), other, _vertex, version[other] };
+						queue.push(collapse);
+					}
+				}
+			}
+		};
+
+		for (U32 i = 0; i < numVertices; i++)
+		{
+			if (!locked[i])
+			{
+				pushCollapses(i);
+			}
+		}
+
+		const F64 maxErrorSq = (F64)_maxError * (F64)_maxError;
+		F64 resultErrorSq = 0.0;
+		U32 remainingTriangles = numTriangles;
+
+		while (remainingTriangles * 3 > _targetIndexCount && !queue.empty())
+		{
+			const Collapse collapse = queue.top();
+			queue.pop();
+
+			if (collapse.cost > maxErrorSq)
+			{
+				break;
+			}
+
+			// Skip stale entries
+			if (!alive[collapse.from] || !alive[collapse.to] || version[collapse.from] != collapse.version)
+			{
+				continue;
+			}
+
+			// Reject collapses that flip or degenerate a remaining triangle
+			bool adjacent = false;
+			bool flips = false;
+			for (U32 triangle : vertexTriangles[collapse.from])
+			{
+				if (!triangleAlive[triangle])
+				{
+					continue;
+				}
+
+				const U32* tri = &indices[triangle * 3];
+				if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to)
+				{
+					adjacent = true;
+					continue;
+				}
+
+				base::Vec3 before[3];
+				base::Vec3 after[3];
+				for (U32 j = 0; j < 3; j++)
+				{
+					before[j] = getPosition(_vertices[tri[j]]);
+					after[j] = tri[j] == collapse.from ? getPosition(_vertices[collapse.to]) : before[j];
+				}
+
+				const base::Vec3 normalBefore = base::cross(base::sub(before[1], before[0]), base::sub(before[2], before[0]));
+				const base::Vec3 normalAfter = base::cross(base::sub(after[1], after[0]), base::sub(after[2], after[0]));
+				if (base::dot(normalBefore, normalAfter) <= 0.25f * base::length(normalBefore) * base::length(normalAfter))
+				{
+					flips = true;
+					break;
+				}
+			}
+
+			if (!adjacent || flips)
+			{
+				continue;
+			}
+
+			// Collapse, triangles sharing the edge disappear
+			for (U32 triangle : vertexTriangles[collapse.from])
+			{
+				if (!triangleAlive[triangle])
+				{
+					continue;
+				}
+
+				U32* tri = &indices[triangle * 3];
+				if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to)
+				{
+					triangleAlive[triangle] = false;
+					remainingTriangles--;
+					continue;
+				}
+
+				for (U32 j = 0; j < 3; j++)
+				{
+					if (tri[j] == collapse.from)
+					{
+						tri[j] = collapse.to;
+					}
+				}
+				vertexTriangles[collapse.to].push_back(triangle);
+			}
+
+			alive[collapse.from] = false;
+			quadricAdd(quadrics[collapse.to], quadrics[collapse.from]);
+			version[collapse.to]++;
+			resultErrorSq = base::max(resultErrorSq, collapse.cost);
+
+			pushCollapses(collapse.to);
+		}
+
+		_outIndices.clear();
+		_outIndices.reserve(remainingTriangles * 3);
+		for (U32 i = 0; i < numTriangles; i++)
+		{
+			if (triangleAlive[i])
+			{
+				_outIndices.insert(_outIndices.end(), indices.begin() + i * 3, indices.begin() + i * 3 + 3);
+			}
+		}
+
+		return (F32)base::sqrt((F32)resultErrorSq);
+	}
+
+} // namespace compiler
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "geometry.h"
+
+// std
+#include <vector>
+
+namespace compiler
+{
+	// Simplifies a welded mesh with quadric error metric edge collapses (Garland & Heckbert 1997).
+	//
+	// Vertices are only ever collapsed onto an existing neighbour, so every remaining vertex keeps its
+	// exact position, UV and normal. Vertices on UV or normal seams and on open borders are locked, and
+	// collapses that would flip a triangle are rejected. Stops at _targetIndexCount or when the next
+	// collapse would exceed _maxError, the area weighted RMS distance to the original planes in mesh space.
+	// Returns the largest error introduced, in the same units.
+	F32 simplifyMesh(std::vector<U32>& _outIndices, const std::vector<MeshVertex>& _vertices, const std::vector<U32>& _indices,
+		U32 _targetIndexCount, F32 _maxError);
+
+} // namespace compiler
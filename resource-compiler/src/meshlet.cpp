@@ -0,0 +1,175 @@
+#include "meshlet.h"
+
+namespace compiler
+{
+	namespace
+	{
+		base::Vec3 getPosition(const MeshVertex& _vertex)
+		{
+			return { _vertex.x, _vertex.y, _vertex.z };
+		}
+
+		void computeBounds(pakx::Meshlet& _meshlet, const MeshletBuild& _build, const std::vector<MeshVertex>& _vertices)
+		{
+			const U32* meshletVertices = &_build.vertices[_meshlet.vertexOffset];
+			const U8* meshletTriangles = &_build.triangles[_meshlet.triangleOffset];
+
+			// Sphere around the AABB center
+			base::Vec3 min = { base::kFloatMax, base::kFloatMax, base::kFloatMax };
+			base::Vec3 max = { -base::kFloatMax, -base::kFloatMax, -base::kFloatMax };
+			for (U32 i = 0; i < _meshlet.numVertices; i++)
+			{
+				const base::Vec3 position = getPosition(_vertices[meshletVertices[i]]);
+				min = base::min(min, position);
+				max = base::max(max, position);
+			}
+
+			const base::Vec3 center = base::mul(base::add(min, max), 0.5f);
+			F32 radius = 0.0f;
+			for (U32 i = 0; i < _meshlet.numVertices; i++)
+			{
+				radius = base::max(radius, base::length(base::sub(getPosition(_vertices[meshletVertices[i]]), center)));
+			}
+
+			// Normal cone from the triangle normals
+			std::vector<base::Vec3> normals;
+			normals.reserve(_meshlet.numTriangles);
+			base::Vec3 axis = { 0.0f, 0.0f, 0.0f };
+			for (U32 i = 0; i < _meshlet.numTriangles; i++)
+			{
+				const base::Vec3 p0 = getPosition(_vertices[meshletVertices[meshletTriangles[i * 3 + 0]]]);
+				const base::Vec3 p1 = getPosition(_vertices[meshletVertices[meshletTriangles[i * 3 + 1]]]);
+				const base::Vec3 p2 = getPosition(_vertices[meshletVertices[meshletTriangles[i * 3 + 2]]]);
+
+				const base::Vec3 normal = base::cross(base::sub(p1, p0), base::sub(p2, p0));
+				const F32 length = base::length(normal);
+				if (length > 0.0f)
+				{
+					normals.push_back(base::mul(normal, 1.0f / length));
+					axis = base::add(axis, normals.back());
+				}
+			}
+
+			const F32 axisLength = base::length(axis);
+			axis = axisLength > 0.0f ? base::mul(axis, 1.0f / axisLength) : base::Vec3{ 0.0f, 0.0f, 0.0f };
+
+			F32 minDot = 1.0f;
+			for (const base::Vec3& normal : normals)
+			{
+				minDot = base::min(minDot, base::dot(normal, axis));
+			}
+
+			_meshlet.center[0] = center.x;
+			_meshlet.center[1] = center.y;
+			_meshlet.center[2] = center.z;
+			_meshlet.radius = radius;
+			_meshlet.coneAxis[0] = axis.x;
+			_meshlet.coneAxis[1] = axis.y;
+			_meshlet.coneAxis[2] = axis.z;
+
+			// Wide cones can never be culled, a cutoff of 1 disables the test
+			_meshlet.coneCutoff = (axisLength <= 0.0f || minDot <= 0.1f) ? 1.0f : base::sqrt(1.0f - minDot * minDot);
+		}
+
+	} // namespace
+
+	void buildMeshlets(MeshletBuild& _out, const std::vector<MeshVertex>& _vertices, const std::vector<U32>& _indices,
+		U32 _maxVertices, U32 _maxTriangles)
+	{
+		const U32 kUnused = 0xFF;
+		std::vector<U8> localIndex(_vertices.size(), kUnused);
+
+		pakx::Meshlet meshlet;
+		base::memSet(&meshlet, 0, sizeof(meshlet));
+		meshlet.vertexOffset = (U32)_out.vertices.size();
+		meshlet.triangleOffset = (U32)_out.triangles.size();
+
+		auto flush = [&]()
+		{
+			if (meshlet.numTriangles == 0)
+			{
+				return;
+			}
+
+			computeBounds(meshlet, _out, _vertices);
+			_out.meshlets.push_back(meshlet);
+
+			for (U32 i = 0; i < meshlet.numVertices; i++)
+			{
+				localIndex[_out.vertices[meshlet.vertexOffset + i]] = kUnused;
+			}
+
+			base::memSet(&meshlet, 0, sizeof(meshlet));
+			meshlet.vertexOffset = (U32)_out.vertices.size();
+			meshlet.triangleOffset = (U32)_out.triangles.size();
+		};
+
+		for (U32 i = 0; i < _indices.size(); i += 3)
+		{
+			const U32 a = _indices[i + 0];
+			const U32 b = _indices[i + 1];
+			const U32 c = _indices[i + 2];
+
+			const U32 newVertices = (localIndex[a] == kUnused) + (localIndex[b] == kUnused) + (localIndex[c] == kUnused);
+			if (meshlet.numVertices + newVertices > _maxVertices || meshlet.numTriangles + 1u > _maxTriangles)
+			{
+				flush();
+			}
+
+			if (meshlet.numTriangles == 0)
+			{
+				meshlet.firstIndex = i;
+			}
+
+			const U32 corners[3] = { a, b, c };
+			for (U32 corner : corners)
+			{
+				if (localIndex[corner] == kUnused)
+				{
+					localIndex[corner] = meshlet.numVertices++;
+					_out.vertices.push_back(corner);
+				}
+				_out.triangles.push_back(localIndex[corner]);
+			}
+			meshlet.numTriangles++;
+		}
+
+		flush();
+	}
+
+	U32 MeshletTableBuilder::add(const MeshletBuild& _build)
+	{
+		const U32 firstMeshlet = (U32)m_all.meshlets.size();
+		const U32 vertexBase = (U32)m_all.vertices.size();
+		const U32 triangleBase = (U32)m_all.triangles.size();
+
+		for (pakx::Meshlet meshlet : _build.meshlets)
+		{
+			meshlet.vertexOffset += vertexBase;
+			meshlet.triangleOffset += triangleBase;
+			m_all.meshlets.push_back(meshlet);
+		}
+		m_all.vertices.insert(m_all.vertices.end(), _build.vertices.begin(), _build.vertices.end());
+		m_all.triangles.insert(m_all.triangles.end(), _build.triangles.begin(), _build.triangles.end());
+
+		return firstMeshlet;
+	}
+
+	ChunkData MeshletTableBuilder::serialize() const
+	{
+		ChunkData chunk;
+
+		pakx::MeshletsHeader header;
+		header.numMeshlets = (U32)m_all.meshlets.size();
+		header.numVertices = (U32)m_all.vertices.size();
+		header.numTriangles = (U32)m_all.triangles.size() / 3;
+		header.reserved = 0;
+		chunkWrite(chunk, header);
+		chunkWrite(chunk, m_all.meshlets.data(), (U32)(m_all.meshlets.size() * sizeof(pakx::Meshlet)));
+		chunkWrite(chunk, m_all.vertices.data(), (U32)(m_all.vertices.size() * sizeof(U32)));
+		chunkWrite(chunk, m_all.triangles.data(), (U32)m_all.triangles.size());
+
+		return chunk;
+	}
+
+} // namespace compiler
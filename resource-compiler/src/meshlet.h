@@ -0,0 +1,33 @@
+#pragma once
+
+#include "pakx_writer.h"
+#include "geometry.h"
+
+namespace compiler
+{
+	struct MeshletBuild
+	{
+		std::vector<pakx::Meshlet> meshlets;
+		std::vector<U32> vertices;
+		std::vector<U8> triangles;
+	};
+
+	// Splits an index buffer into meshlets of at most _maxVertices vertices and _maxTriangles triangles.
+	// Triangles are taken in index buffer order, so a vertex cache optimized mesh gives compact clusters
+	// and the index buffer itself stays untouched. Every meshlet gets a bounding sphere and normal cone.
+	void buildMeshlets(MeshletBuild& _out, const std::vector<MeshVertex>& _vertices, const std::vector<U32>& _indices,
+		U32 _maxVertices, U32 _maxTriangles);
+
+	// Collects meshlets of all meshes into the meshlets chunk.
+	class MeshletTableBuilder
+	{
+	public:
+		// Returns index of the first meshlet inside the chunk.
+		U32 add(const MeshletBuild& _build);
+		ChunkData serialize() const;
+
+	private:
+		MeshletBuild m_all;
+	};
+
+} // namespace compiler
@@ -0,0 +1,107 @@
+#include "morph_target.h"
+
+// std
+#include <unordered_map>
+
+namespace compiler
+{
+	namespace
+	{
+		// Offsets below this are treated as not moving the vertex
+		constexpr F32 kMinOffset = 1e-6f;
+
+	} // namespace
+
+	void buildMorphTargets(std::vector<MorphTargetBuild>& _out, const std::vector<MorphTarget>& _targets,
+		const std::vector<U32>& _sourceVertices, F32 _scale)
+	{
+		_out.clear();
+		if (_targets.empty())
+		{
+			return;
+		}
+
+		std::unordered_map<U32, U32> offsetLookup;
+		for (const MorphTarget& target : _targets)
+		{
+			offsetLookup.clear();
+			for (U32 i = 0; i < target.sourceVertices.size(); i++)
+			{
+				offsetLookup[target.sourceVertices[i]] = i;
+			}
+
+			// Gather moved vertices, then quantize against the largest offset of this target
+			std::vector<U32> movedVertices;
+			std::vector<base::Vec3> movedOffsets;
+			F32 maxOffset = 0.0f;
+			for (U32 i = 0; i < _sourceVertices.size(); i++)
+			{
+				auto it = offsetLookup.find(_sourceVertices[i]);
+				if (it == offsetLookup.end())
+				{
+					continue;
+				}
+
+				const base::Vec3 offset = base::mul(target.offsets[it->second], 1.0f / _scale);
+				const F32 largest = base::max(base::abs(offset.x), base::max(base::abs(offset.y), base::abs(offset.z)));
+				if (largest <= kMinOffset)
+				{
+					continue;
+				}
+
+				movedVertices.push_back(i);
+				movedOffsets.push_back(offset);
+				maxOffset = base::max(maxOffset, largest);
+			}
+
+			MorphTargetBuild build;
+			build.target.nameHash = pakx::hashVfp(target.name.c_str());
+			build.target.firstDelta = 0;
+			build.target.numDeltas = (U32)movedVertices.size();
+			build.target.scale = maxOffset > 0.0f ? maxOffset / 32767.0f : 1.0f;
+
+			build.deltas.resize(movedVertices.size());
+			for (U32 i = 0; i < movedVertices.size(); i++)
+			{
+				pakx::MorphDelta& delta = build.deltas[i];
+				delta.vertex = movedVertices[i];
+				delta.position[0] = (I16)base::round(movedOffsets[i].x / build.target.scale);
+				delta.position[1] = (I16)base::round(movedOffsets[i].y / build.target.scale);
+				delta.position[2] = (I16)base::round(movedOffsets[i].z / build.target.scale);
+				delta.reserved = 0;
+			}
+
+			_out.push_back(build);
+		}
+	}
+
+	U32 MorphTableBuilder::add(const std::vector<MorphTargetBuild>& _builds)
+	{
+		const U32 firstTarget = (U32)m_targets.size();
+
+		for (const MorphTargetBuild& build : _builds)
+		{
+			pakx::MorphTarget target = build.target;
+			target.firstDelta = (U32)m_deltas.size();
+			m_targets.push_back(target);
+			m_deltas.insert(m_deltas.end(), build.deltas.begin(), build.deltas.end());
+		}
+
+		return firstTarget;
+	}
+
+	ChunkData MorphTableBuilder::serialize() const
+	{
+		ChunkData chunk;
+
+		pakx::MorphsHeader header;
+		header.numTargets = (U32)m_targets.size();
+		header.numDeltas = (U32)m_deltas.size();
+		chunkWrite(chunk, header);
+		chunkWrite(chunk, m_targets.data(), (U32)(m_targets.size() * sizeof(pakx::MorphTarget)));
+		chunkWrite(chunk, m_deltas.data(), (U32)(m_deltas.size() * sizeof(pakx::MorphDelta)));
+
+		return chunk;
+	}
+
+} // namespace compiler
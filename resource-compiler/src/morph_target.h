@@ -0,0 +1,42 @@
+#pragma once
+
+#include "pakx_writer.h"
+#include "geometry.h"
+
+namespace compiler
+{
+	// Blend channel of an imported mesh. Offsets are keyed by the FBX vertex they move, so they stay valid
+	// while the mesh's own vertices are welded, reordered and simplified.
+	struct MorphTarget
+	{
+		std::string name;
+		std::vector<U32> sourceVertices;
+		std::vector<base::Vec3> offsets;
+	};
+
+	struct MorphTargetBuild
+	{
+		pakx::MorphTarget target;
+		std::vector<pakx::MorphDelta> deltas;
+	};
+
+	// Resolves morph targets onto the final vertices of a mesh, _sourceVertices holds the FBX vertex of
+	// each of them. Offsets are divided by _scale to move them into quantized space.
+	void buildMorphTargets(std::vector<MorphTargetBuild>& _out, const std::vector<MorphTarget>& _targets,
+		const std::vector<U32>& _sourceVertices, F32 _scale);
+
+	class MorphTableBuilder
+	{
+	public:
+		// Returns index of the first target inside the chunk.
+		U32 add(const std::vector<MorphTargetBuild>& _builds);
+		ChunkData serialize() const;
+
+		U32 getNumDeltas() const { return (U32)m_deltas.size(); }
+
+	private:
+		std::vector<pakx::MorphTarget> m_targets;
+		std::vector<pakx::MorphDelta> m_deltas;
+	};
+
+} // namespace compiler
@@ -0,0 +1,181 @@
+#include "pakx_writer.h"
+
+namespace compiler
+{
+	void PakxWriter::addChunk(U32 _fourcc, const ChunkData& _data)
+	{
+		Chunk chunk;
+		chunk.fourcc = _fourcc;
+		chunk.data = _data;
+		m_chunks.push_back(chunk);
+	}
+
+	bool PakxWriter::write(const base::FilePath& _filePath) const
+	{
+		base::FileWriter writer;
+		base::Error err;
+		if (!base::open(&writer, _filePath, false, &err))
+		{
+			BASE_TRACE("Failed: Opening %s for writing", _filePath.getCPtr())
+			return false;
+		}
+
+		pakx::Header header;
+		header.magic = pakx::kMagic;
+		header.version = pakx::kVersion;
+		header.numChunks = (U32)m_chunks.size();
+		header.reserved = 0;
+		base::write(&writer, &header, sizeof(header), &err);
+
+		// Chunk table, data follows directly after
+		U64 offset = sizeof(pakx::Header) + m_chunks.size() * sizeof(pakx::Chunk);
+		for (const Chunk& chunk : m_chunks)
+		{
+			pakx::Chunk entry;
+			entry.fourcc = chunk.fourcc;
+			entry.reserved = 0;
+			entry.offset = offset;
+			entry.size = chunk.data.size();
+			base::write(&writer, &entry, sizeof(entry), &err);
+
+			offset += chunk.data.size();
+		}
+
+		for (const Chunk& chunk : m_chunks)
+		{
+			base::write(&writer, chunk.data.data(), (I32)chunk.data.size(), &err);
+		}
+
+		base::close(&writer);
+		return err.isOk();
+	}
+
+	PrefabTableBuilder::PrefabTableBuilder()
+		: m_numNodes(0)
+	{}
+
+	void PrefabTableBuilder::addPrefab(const base::FilePath& _vfp, const std::vector<pakx::Mesh>& _meshes, U32 _numParts,
+		const std::vector<PrefabNode>& _nodes, U32 _contentHash)
+	{
+		pakx::Prefab prefab;
+		prefab.vfpHash = pakx::hashVfp(_vfp.getCPtr());
+		prefab.firstMesh = (U32)m_meshes.size();
+		prefab.numMeshes = (U32)_meshes.size();
+		prefab.numParts = _numParts;
+		prefab.nodeOffset = (U32)(sizeof(pakx::NodesHeader) + m_nodes.size());
+		prefab.numNodes = (U32)_nodes.size();
+		prefab.contentHash = _contentHash;
+		m_prefabs.push_back(prefab);
+
+		m_meshes.insert(m_meshes.end(), _meshes.begin(), _meshes.end());
+
+		// Each field of the nodes goes into an array of its own
+		for (const PrefabNode& node : _nodes)
+		{
+			chunkWrite(m_nodes, node.parent);
+		}
+		for (const PrefabNode& node : _nodes)
+		{
+			chunkWrite(m_nodes, node.translation, sizeof(node.translation));
+		}
+		for (const PrefabNode& node : _nodes)
+		{
+			chunkWrite(m_nodes, node.rotation, sizeof(node.rotation));
+		}
+		for (const PrefabNode& node : _nodes)
+		{
+			chunkWrite(m_nodes, node.scale, sizeof(node.scale));
+		}
+		m_numNodes += (U32)_nodes.size();
+	}
+
+	ChunkData PrefabTableBuilder::serialize() const
+	{
+		ChunkData chunk;
+
+		pakx::PrefabsHeader header;
+		header.numPrefabs = (U32)m_prefabs.size();
+		header.numMeshes = (U32)m_meshes.size();
+		chunkWrite(chunk, header);
+		chunkWrite(chunk, m_prefabs.data(), (U32)(m_prefabs.size() * sizeof(pakx::Prefab)));
+		chunkWrite(chunk, m_meshes.data(), (U32)(m_meshes.size() * sizeof(pakx::Mesh)));
+
+		return chunk;
+	}
+
+	ChunkData PrefabTableBuilder::serializeNodes() const
+	{
+		ChunkData chunk;
+
+		pakx::NodesHeader header;
+		header.numNodes = m_numNodes;
+		header.reserved = 0;
+		chunkWrite(chunk, header);
+		chunkWrite(chunk, m_nodes.data(), (U32)m_nodes.size());
+
+		return chunk;
+	}
+
+	U32 MaterialTableBuilder::addMaterial(const base::FilePath& _vfp, const pakx::MaterialBlock& _block)
+	{
+		for (U32 i = 0; i < m_vfps.size(); i++)
+		{
+			if (m_vfps[i] == _vfp.getCPtr() && 0 == base::memCmp(&m_blocks[i], &_block, sizeof(_block)))
+			{
+				return i;
+			}
+		}
+
+		m_vfps.push_back(_vfp.getCPtr());
+		m_blocks.push_back(_block);
+		return (U32)(m_blocks.size() - 1);
+	}
+
+	ChunkData MaterialTableBuilder::serialize() const
+	{
+		ChunkData chunk;
+
+		pakx::MaterialsHeader header;
+		header.numMaterials = (U32)m_blocks.size();
+		header.numVec4s = pakx::kMaterialBlockVec4s;
+		chunkWrite(chunk, header);
+		chunkWrite(chunk, m_blocks.data(), (U32)(m_blocks.size() * sizeof(pakx::MaterialBlock)));
+
+		return chunk;
+	}
+
+	void ResourceTableBuilder::addResource(const base::FilePath& _vfp, pakx::ResourceType::Enum _type, U32 _cpuBytes, U32 _gpuBytes)
+	{
+		pakx::Resource resource;
+		base::memSet(&resource, 0, sizeof(resource));
+		resource.vfpHash = pakx::hashVfp(_vfp.getCPtr());
+		resource.type = _type;
+		resource.cpuBytes = _cpuBytes;
+		resource.gpuBytes = _gpuBytes;
+
+		for (pakx::Resource& existing : m_resources)
+		{
+			if (existing.vfpHash == resource.vfpHash)
+			{
+				existing = resource;
+				return;
+			}
+		}
+
+		m_resources.push_back(resource);
+	}
+
+	ChunkData ResourceTableBuilder::serialize() const
+	{
+		ChunkData chunk;
+
+		pakx::ResourcesHeader header;
+		header.numResources = (U32)m_resources.size();
+		header.reserved = 0;
+		chunkWrite(chunk, header);
+		chunkWrite(chunk, m_resources.data(), (U32)(m_resources.size() * sizeof(pakx::Resource)));
+
+		return chunk;
+	}
+
+} // namespace compiler
@@ -0,0 +1,100 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+// shared
+#include <pakx.h>
+
+// std
+#include <string>
+#include <vector>
+
+namespace compiler
+{
+	typedef std::vector<U8> ChunkData;
+
+	template<typename Ty>
+	inline void chunkWrite(ChunkData& _chunk, const Ty& _value)
+	{
+		const U8* data = (const U8*)&_value;
+		_chunk.insert(_chunk.end(), data, data + sizeof(Ty));
+	}
+
+	inline void chunkWrite(ChunkData& _chunk, const void* _data, U32 _size)
+	{
+		const U8* data = (const U8*)_data;
+		_chunk.insert(_chunk.end(), data, data + _size);
+	}
+
+	// Collects chunks during a build and writes them as one .pakx file.
+	class PakxWriter
+	{
+	public:
+		void addChunk(U32 _fourcc, const ChunkData& _data);
+		bool write(const base::FilePath& _filePath) const;
+
+	private:
+		struct Chunk
+		{
+			U32 fourcc;
+			ChunkData data;
+		};
+
+		std::vector<Chunk> m_chunks;
+	};
+
+	struct PrefabNode
+	{
+		U32 parent; // Prefab-local index, pakx::kInvalidIndex for roots
+		F32 translation[3];
+		F32 rotation[4];
+		F32 scale[3];
+	};
+
+	// Per prefab mesh records, stored in the same order as the prefab mesh paths, and node hierarchies.
+	class PrefabTableBuilder
+	{
+	public:
+		PrefabTableBuilder();
+
+		// Nodes must be in breadth-first order. The content hash lets the runtime skip prefabs that didn't
+		// change when it reloads the PAK.
+		void addPrefab(const base::FilePath& _vfp, const std::vector<pakx::Mesh>& _meshes, U32 _numParts,
+			const std::vector<PrefabNode>& _nodes, U32 _contentHash);
+		ChunkData serialize() const;
+		ChunkData serializeNodes() const;
+
+	private:
+		std::vector<pakx::Prefab> m_prefabs;
+		std::vector<pakx::Mesh> m_meshes;
+		ChunkData m_nodes; // Nodes chunk without its header
+		U32 m_numNodes;
+	};
+
+	// Packed uniform blocks, one per material resource.
+	class MaterialTableBuilder
+	{
+	public:
+		// Returns the index of the material, adding it unless one with the same path and block exists.
+		U32 addMaterial(const base::FilePath& _vfp, const pakx::MaterialBlock& _block);
+		ChunkData serialize() const;
+
+	private:
+		std::vector<std::string> m_vfps;
+		std::vector<pakx::MaterialBlock> m_blocks;
+	};
+
+	// Memory cost of every resource written to the PAK.
+	class ResourceTableBuilder
+	{
+	public:
+		// Adding a resource again replaces its sizes, resources are keyed by their path.
+		void addResource(const base::FilePath& _vfp, pakx::ResourceType::Enum _type, U32 _cpuBytes, U32 _gpuBytes);
+		ChunkData serialize() const;
+
+	private:
+		std::vector<pakx::Resource> m_resources;
+	};
+
+} // namespace compiler
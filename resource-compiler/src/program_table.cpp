@@ -0,0 +1,81 @@
+#include "program_table.h"
+
+namespace compiler
+{
+	U16 ProgramTableBuilder::addProgram(const char* _vertShaderPath, const char* _fragShaderPath)
+	{
+		pakx::Program program;
+		program.vertexShader = addShader(_vertShaderPath);
+		program.fragmentShader = addShader(_fragShaderPath);
+
+		for (U32 i = 0; i < m_programs.size(); i++)
+		{
+			if (m_programs[i].vertexShader == program.vertexShader && m_programs[i].fragmentShader == program.fragmentShader)
+			{
+				return (U16)i;
+			}
+		}
+
+		m_programs.push_back(program);
+		return (U16)(m_programs.size() - 1);
+	}
+
+	ChunkData ProgramTableBuilder::serialize(const ShaderBuilder& _shaders) const
+	{
+		ChunkData chunk;
+
+		pakx::ProgramsHeader header;
+		header.numShaders = (U32)m_shaders.size();
+		header.numPrograms = (U32)m_programs.size();
+		chunkWrite(chunk, header);
+
+		// Bytecode follows the tables
+		U32 offset = (U32)(sizeof(pakx::ProgramsHeader) + m_shaders.size() * sizeof(pakx::ProgramShader)
+			+ m_programs.size() * sizeof(pakx::Program));
+		for (const std::string& vfp : m_shaders)
+		{
+			const std::vector<U8>* bytecode = _shaders.findBytecode(vfp.c_str());
+			if (NULL == bytecode)
+			{
+				BASE_TRACE("Failed: No bytecode for %s in program table", vfp.c_str())
+			}
+
+			pakx::ProgramShader shader;
+			shader.vfpHash = pakx::hashVfp(vfp.c_str());
+			shader.offset = offset;
+			shader.size = NULL != bytecode ? (U32)bytecode->size() : 0;
+			shader.reserved = 0;
+			chunkWrite(chunk, shader);
+
+			offset += shader.size;
+		}
+
+		chunkWrite(chunk, m_programs.data(), (U32)(m_programs.size() * sizeof(pakx::Program)));
+
+		for (const std::string& vfp : m_shaders)
+		{
+			const std::vector<U8>* bytecode = _shaders.findBytecode(vfp.c_str());
+			if (NULL != bytecode)
+			{
+				chunkWrite(chunk, bytecode->data(), (U32)bytecode->size());
+			}
+		}
+
+		return chunk;
+	}
+
+	U32 ProgramTableBuilder::addShader(const char* _vfp)
+	{
+		for (U32 i = 0; i < m_shaders.size(); i++)
+		{
+			if (m_shaders[i] == _vfp)
+			{
+				return i;
+			}
+		}
+
+		m_shaders.push_back(_vfp);
+		return (U32)(m_shaders.size() - 1);
+	}
+
+} // namespace compiler
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "pakx_writer.h"
+#include "shader_build.h"
+
+namespace compiler
+{
+	// Collects the unique vertex/fragment shader pairs used by materials into the programs chunk, so the
+	// runtime can create every program once up front.
+	class ProgramTableBuilder
+	{
+	public:
+		// Returns the program index of the pair, adding it if it's new.
+		U16 addProgram(const char* _vertShaderPath, const char* _fragShaderPath);
+		ChunkData serialize(const ShaderBuilder& _shaders) const;
+
+		U32 getNumPrograms() const { return (U32)m_programs.size(); }
+
+	private:
+		U32 addShader(const char* _vfp);
+
+		std::vector<std::string> m_shaders;
+		std::vector<pakx::Program> m_programs;
+	};
+
+} // namespace compiler
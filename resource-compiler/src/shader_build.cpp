@@ -0,0 +1,363 @@
+#include "shader_build.h"
+
+// std
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace compiler
+{
+	namespace
+	{
+		// shaderc keeps global state in its preprocessor and compiler front ends, so only one variant
+		// compiles at a time. Workers still hash sources and read the cache in parallel.
+		std::mutex s_compileMutex;
+
+		constexpr U32 kCacheMagic = BASE_MAKEFOURCC('S', 'H', 'C', '1');
+
+		// Followed by the key and the bytecode
+		struct CacheHeader
+		{
+			U32 magic;
+			U32 keySize;
+			U32 bytecodeSize;
+		};
+
+		bool readFile(std::vector<U8>& _out, const base::FilePath& _filePath)
+		{
+			base::FileReader reader;
+			base::Error err;
+			if (!base::open(&reader, _filePath, &err))
+			{
+				return false;
+			}
+
+			const U32 size = (U32)base::getSize(&reader);
+			_out.resize(size);
+			base::read(&reader, _out.data(), (I32)size, &err);
+			base::close(&reader);
+
+			return err.isOk();
+		}
+
+		// Appends a source file together with everything it includes. shaderc resolves includes relative
+		// to the including file, so both "" and <> includes are looked up next to it.
+		void readSources(std::vector<U8>& _out, const std::string& _path, std::set<std::string>& _visited)
+		{
+			if (!_visited.insert(_path).second)
+			{
+				return;
+			}
+
+			std::vector<U8> source;
+			if (!readFile(source, _path.c_str()))
+			{
+				return;
+			}
+			_out.insert(_out.end(), source.begin(), source.end());
+
+			const std::string directory = _path.substr(0, _path.find_last_of("/\\") + 1);
+			const std::string text(source.begin(), source.end());
+
+			size_t pos = 0;
+			while ((pos = text.find("#include", pos)) != std::string::npos)
+			{
+				pos += 8;
+				const size_t open = text.find_first_of("\"<", pos);
+				const size_t lineEnd = text.find('\n', pos);
+				if (open == std::string::npos || open > lineEnd)
+				{
+					continue;
+				}
+
+				const size_t close = text.find_first_of("\">", open + 1);
+				if (close == std::string::npos || close > lineEnd)
+				{
+					continue;
+				}
+
+				readSources(_out, directory + text.substr(open + 1, close - open - 1), _visited);
+			}
+		}
+
+		U64 hash64(const void* _data, U32 _size)
+		{
+			base::HashMurmur2A low;
+			low.begin(0);
+			low.add(_data, (I32)_size);
+
+			base::HashMurmur2A high;
+			high.begin(0x9e3779b9);
+			high.add(_data, (I32)_size);
+
+			return (U64(high.end()) << 32) | low.end();
+		}
+
+		// Entries are only used if they were written completely and under the same key
+		bool readCache(std::vector<U8>& _out, const base::FilePath& _filePath, const std::string& _key)
+		{
+			std::vector<U8> data;
+			if (!readFile(data, _filePath) || data.size() < sizeof(CacheHeader))
+			{
+				return false;
+			}
+
+			CacheHeader header;
+			base::memCopy(&header, data.data(), sizeof(header));
+			if (header.magic != kCacheMagic
+				|| header.keySize != _key.size()
+				|| header.bytecodeSize == 0
+				|| data.size() != sizeof(header) + header.keySize + header.bytecodeSize
+				|| 0 != base::memCmp(data.data() + sizeof(header), _key.data(), header.keySize))
+			{
+				return false;
+			}
+
+			const U8* bytecode = data.data() + sizeof(header) + header.keySize;
+			_out.assign(bytecode, bytecode + header.bytecodeSize);
+			return true;
+		}
+
+		// Written next to the entry and renamed over it, a build killed while writing leaves no partial entry
+		void writeCache(const base::FilePath& _filePath, const std::string& _key, const graphics::Memory* _mem)
+		{
+			const std::string tempPath = std::string(_filePath.getCPtr()) + ".tmp";
+
+			base::FileWriter writer;
+			base::Error err;
+			if (!base::open(&writer, tempPath.c_str(), false, &err))
+			{
+				return;
+			}
+
+			CacheHeader header;
+			header.magic = kCacheMagic;
+			header.keySize = (U32)_key.size();
+			header.bytecodeSize = _mem->size;
+			base::write(&writer, &header, sizeof(header), &err);
+			base::write(&writer, _key.data(), (I32)_key.size(), &err);
+			base::write(&writer, _mem->data, (I32)_mem->size, &err);
+			base::close(&writer);
+
+			// Windows can't rename over an existing file
+			std::remove(_filePath.getCPtr());
+			if (!err.isOk() || 0 != std::rename(tempPath.c_str(), _filePath.getCPtr()))
+			{
+				std::remove(tempPath.c_str());
+			}
+		}
+
+	} // namespace
+
+	ShaderBuilder::ShaderBuilder()
+		: m_numCompiled(0)
+		, m_numCached(0)
+		, m_numFailed(0)
+	{}
+
+	void ShaderBuilder::addProfile(const char* _name, const char* _platform, const char* _profile)
+	{
+		Profile profile;
+		profile.name = _name;
+		profile.platform = _platform;
+		profile.profile = _profile;
+		m_profiles.push_back(profile);
+	}
+
+	void ShaderBuilder::addShader(const base::FilePath& _shaderPath, const base::FilePath& _varyingPath,
+		graphics::ShaderType::Enum _type, const char* _name, const std::vector<std::string>& _defines)
+	{
+		Shader shader;
+		shader.path = _shaderPath.getCPtr();
+		shader.varyingPath = _varyingPath.getCPtr();
+		shader.type = _type;
+		shader.name = _name;
+		shader.defines = _defines;
+		m_shaders.push_back(shader);
+	}
+
+	bool ShaderBuilder::build(const base::FilePath& _cacheDir, U32 _numThreads)
+	{
+		base::make(_cacheDir);
+
+		// One job per shader, profile and define combination
+		std::vector<Job> jobs;
+		for (U32 shaderIndex = 0; shaderIndex < m_shaders.size(); shaderIndex++)
+		{
+			const Shader& shader = m_shaders[shaderIndex];
+			for (U32 profileIndex = 0; profileIndex < m_profiles.size(); profileIndex++)
+			{
+				for (U32 mask = 0; mask < (1u << shader.defines.size()); mask++)
+				{
+					Job job;
+					job.shader = shaderIndex;
+					job.profile = profileIndex;
+					job.defineMask = mask;
+					job.mem = NULL;
+					job.isCached = false;
+					job.isOk = false;
+
+					job.vfp = "shaders/";
+					if (profileIndex > 0)
+					{
+						job.vfp += m_profiles[profileIndex].name + "/";
+					}
+					job.vfp += shader.name;
+
+					for (U32 i = 0; i < shader.defines.size(); i++)
+					{
+						if (0 == (mask & (1u << i)))
+						{
+							continue;
+						}
+
+						job.defines += job.defines.empty() ? "" : ";";
+						job.defines += shader.defines[i];
+
+						std::string suffix = shader.defines[i];
+						for (char& c : suffix)
+						{
+							c = (char)base::toLower(c);
+						}
+						job.vfp += "_" + suffix;
+					}
+					job.vfp += ".bin";
+
+					jobs.push_back(job);
+				}
+			}
+		}
+
+		// Workers pull jobs until none are left
+		std::atomic<U32> nextJob(0);
+		auto worker = [&]()
+		{
+			for (U32 i = nextJob++; i < jobs.size(); i = nextJob++)
+			{
+				runJob(jobs[i], _cacheDir);
+			}
+		};
+
+		const U32 numThreads = base::max(1u, base::min(_numThreads, (U32)jobs.size()));
+		std::vector<std::thread> threads;
+		for (U32 i = 1; i < numThreads; i++)
+		{
+			threads.push_back(std::thread(worker));
+		}
+		worker();
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		// Resources are created on the calling thread
+		for (Job& job : jobs)
+		{
+			if (!job.isOk)
+			{
+				BASE_TRACE("Failed: Compiling %s (%s)", job.vfp.c_str(), job.defines.c_str())
+				m_numFailed++;
+				continue;
+			}
+
+			if (NULL != job.mem)
+			{
+				job.bytecode.assign(job.mem->data, job.mem->data + job.mem->size);
+			}
+
+			if (job.profile == 0)
+			{
+				m_bytecode[job.vfp] = job.bytecode;
+			}
+
+			mara::ShaderCreate data;
+			data.mem = NULL != job.mem ? job.mem : graphics::copy(job.bytecode.data(), (U32)job.bytecode.size());
+			mara::createResource(data, job.vfp.c_str());
+
+			if (job.isCached)
+			{
+				m_numCached++;
+			}
+			else
+			{
+				m_numCompiled++;
+			}
+		}
+
+		return m_numFailed == 0;
+	}
+
+	const std::vector<U8>* ShaderBuilder::findBytecode(const char* _vfp) const
+	{
+		auto it = m_bytecode.find(_vfp);
+		return it != m_bytecode.end() ? &it->second : NULL;
+	}
+
+	void ShaderBuilder::runJob(Job& _job, const base::FilePath& _cacheDir)
+	{
+		const Shader& shader = m_shaders[_job.shader];
+		const Profile& profile = m_profiles[_job.profile];
+
+		const char* type = "";
+		if (shader.type == graphics::ShaderType::Vertex)   type = "v";
+		if (shader.type == graphics::ShaderType::Fragment) type = "f";
+		if (shader.type == graphics::ShaderType::Compute)  type = "c";
+
+		// Cache key covers every option passed to shaderc and the sources with their includes
+		{
+			std::vector<U8> sources;
+			std::set<std::string> visited;
+			readSources(sources, shader.path, visited);
+			readSources(sources, shader.varyingPath, visited);
+
+			char sourceHash[32];
+			base::snprintf(sourceHash, sizeof(sourceHash), "%016llx", (unsigned long long)hash64(sources.data(), (U32)sources.size()));
+			_job.key = std::string(type) + "|" + profile.platform + "|" + profile.profile + "|" + _job.defines + "|" + sourceHash;
+		}
+
+		char cacheName[32];
+		base::snprintf(cacheName, sizeof(cacheName), "%016llx.bin", (unsigned long long)hash64(_job.key.data(), (U32)_job.key.size()));
+		base::FilePath cachePath = _cacheDir;
+		cachePath.join(cacheName);
+
+		if (readCache(_job.bytecode, cachePath, _job.key))
+		{
+			_job.isCached = true;
+			_job.isOk = true;
+			return;
+		}
+
+		int argc = 0;
+		const char* argv[13];
+		argv[argc++] = "-f";
+		argv[argc++] = shader.path.c_str();
+		argv[argc++] = "--varyingdef";
+		argv[argc++] = shader.varyingPath.c_str();
+		argv[argc++] = "--type";
+		argv[argc++] = type;
+		argv[argc++] = "--platform";
+		argv[argc++] = profile.platform.c_str();
+		argv[argc++] = "--profile";
+		argv[argc++] = profile.profile.c_str();
+		if (!_job.defines.empty())
+		{
+			argv[argc++] = "--define";
+			argv[argc++] = _job.defines.c_str();
+		}
+		argv[argc++] = "--O";
+		{
+			std::lock_guard<std::mutex> lock(s_compileMutex);
+			_job.mem = graphics::compileShader(argc, argv);
+		}
+		if (NULL == _job.mem)
+		{
+			return;
+		}
+		_job.isOk = true;
+
+		writeCache(cachePath, _job.key, _job.mem);
+	}
+
+} // namespace compiler
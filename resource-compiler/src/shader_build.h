@@ -0,0 +1,85 @@
+#pragma once
+
+// mara
+#include <mara/mara.h>
+
+// std
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace compiler
+{
+	// Compiles every permutation of a set of shaders for a list of target profiles. Variants are hashed and
+	// looked up on worker threads, shaderc compiles one at a time. Bytecode is cached on disk by a hash of
+	// the source, its includes and the compile options, so only variants affected by a change are compiled
+	// again.
+	class ShaderBuilder
+	{
+	public:
+		ShaderBuilder();
+
+		// The first profile added is the one the runtime loads, written as "shaders/<name>.bin". Other
+		// profiles are written as "shaders/<profile>/<name>.bin".
+		void addProfile(const char* _name, const char* _platform, const char* _profile);
+
+		// Adds a variant for every combination of _defines. Variants are named after their defines, e.g.
+		// fs_cube with ALPHA_TEST gives fs_cube and fs_cube_alpha_test.
+		void addShader(const base::FilePath& _shaderPath, const base::FilePath& _varyingPath, graphics::ShaderType::Enum _type,
+			const char* _name, const std::vector<std::string>& _defines);
+
+		// Compiles all variants and creates their shader resources, returns false if any variant failed.
+		bool build(const base::FilePath& _cacheDir, U32 _numThreads);
+
+		// Bytecode of a variant of the first profile after build, NULL if it doesn't exist.
+		const std::vector<U8>* findBytecode(const char* _vfp) const;
+
+		// Bytecode of every variant of the first profile after build, keyed by path.
+		const std::unordered_map<std::string, std::vector<U8> >& getBytecode() const { return m_bytecode; }
+
+		U32 getNumCompiled() const { return m_numCompiled; }
+		U32 getNumCached() const { return m_numCached; }
+		U32 getNumFailed() const { return m_numFailed; }
+
+	private:
+		struct Profile
+		{
+			std::string name;
+			std::string platform;
+			std::string profile;
+		};
+
+		struct Shader
+		{
+			std::string path;
+			std::string varyingPath;
+			graphics::ShaderType::Enum type;
+			std::string name;
+			std::vector<std::string> defines;
+		};
+
+		struct Job
+		{
+			U32 shader;
+			U32 profile;
+			U32 defineMask;
+			std::string vfp;
+			std::string defines;
+			std::string key; // Compile options and a 64 bit hash of the sources, stored in the cache entry
+			std::vector<U8> bytecode;
+			const graphics::Memory* mem; // Freshly compiled bytecode, NULL when loaded from the cache
+			bool isCached;
+			bool isOk;
+		};
+
+		void runJob(Job& _job, const base::FilePath& _cacheDir);
+
+		std::vector<Profile> m_profiles;
+		std::vector<Shader> m_shaders;
+		std::unordered_map<std::string, std::vector<U8> > m_bytecode;
+		U32 m_numCompiled;
+		U32 m_numCached;
+		U32 m_numFailed;
+	};
+
+} // namespace compiler
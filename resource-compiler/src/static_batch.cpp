@@ -0,0 +1,225 @@
+#include "static_batch.h"
+
+// std
+#include <algorithm>
+#include <map>
+
+namespace compiler
+{
+	namespace
+	{
+		struct BatchItem
+		{
+			U32 mesh;
+			base::Vec3 min; // World space bounds
+			base::Vec3 max;
+			base::Vec3 center;
+		};
+
+		void computeWorldBounds(BatchItem& _item, const SceneMesh& _mesh)
+		{
+			_item.min = { base::kFloatMax, base::kFloatMax, base::kFloatMax };
+			_item.max = { -base::kFloatMax, -base::kFloatMax, -base::kFloatMax };
+			for (const MeshVertex& vertex : _mesh.vertices)
+			{
+				const base::Vec3 position = base::mul({ vertex.x, vertex.y, vertex.z }, _mesh.transform);
+				_item.min = base::min(_item.min, position);
+				_item.max = base::max(_item.max, position);
+			}
+			_item.center = base::mul(base::add(_item.min, _item.max), 0.5f);
+		}
+
+		void appendTransformed(SceneMesh& _batch, const SceneMesh& _mesh)
+		{
+			// Normals need the inverse transpose, taken as rows of the inverse for row vectors
+			F32 inverse[16];
+			base::mtxInverse(inverse, _mesh.transform);
+
+			const U32 baseVertex = (U32)_batch.vertices.size();
+			for (MeshVertex vertex : _mesh.vertices)
+			{
+				const base::Vec3 position = base::mul({ vertex.x, vertex.y, vertex.z }, _mesh.transform);
+				vertex.x = position.x;
+				vertex.y = position.y;
+				vertex.z = position.z;
+
+				const base::Vec3 normal = { vertex.nx, vertex.ny, vertex.nz };
+				const base::Vec3 transformed = {
+					base::dot(normal, { inverse[0], inverse[1], inverse[2] }),
+					base::dot(normal, { inverse[4], inverse[5], inverse[6] }),
+					base::dot(normal, { inverse[8], inverse[9], inverse[10] }),
+				};
+				const F32 length = base::length(transformed);
+				if (length > 0.0f)
+				{
+					vertex.nx = transformed.x / length;
+					vertex.ny = transformed.y / length;
+					vertex.nz = transformed.z / length;
+				}
+
+				_batch.vertices.push_back(vertex);
+			}
+
+			for (U32 index : _mesh.indices)
+			{
+				_batch.indices.push_back(baseVertex + index);
+			}
+		}
+
+		void splitBatch(std::vector<SceneMesh>& _out, const std::vector<SceneMesh>& _meshes, BatchItem* _items, U32 _numItems,
+			U32 _maxVertices, F32 _maxExtent)
+		{
+			U32 numVertices = 0;
+			base::Vec3 min = { base::kFloatMax, base::kFloatMax, base::kFloatMax };
+			base::Vec3 max = { -base::kFloatMax, -base::kFloatMax, -base::kFloatMax };
+			base::Vec3 centerMin = min;
+			base::Vec3 centerMax = max;
+			for (U32 i = 0; i < _numItems; i++)
+			{
+				numVertices += (U32)_meshes[_items[i].mesh].vertices.size();
+				min = base::min(min, _items[i].min);
+				max = base::max(max, _items[i].max);
+				centerMin = base::min(centerMin, _items[i].center);
+				centerMax = base::max(centerMax, _items[i].center);
+			}
+
+			const base::Vec3 extent = base::sub(max, min);
+			const bool fits = numVertices <= _maxVertices && base::max(extent.x, base::max(extent.y, extent.z)) <= _maxExtent;
+			if (_numItems == 1 || fits)
+			{
+				const SceneMesh& first = _meshes[_items[0].mesh];
+
+				SceneMesh batch;
+				char suffix[32];
+				base::snprintf(suffix, sizeof(suffix), "_batch%d", (U32)_out.size());
+				batch.name = first.name + suffix;
+				batch.materialPath = first.materialPath;
+				batch.texture = first.texture;
+				batch.textureArray = first.textureArray;
+				batch.program = first.program;
+				batch.material = first.material;
+				batch.lodGroup = pakx::kInvalidIndex;
+				batch.lodLevel = 0;
+				batch.lodThreshold = 0.0f;
+				batch.node = pakx::kInvalidIndex;
+				base::mtxIdentity(batch.transform);
+				base::mtxIdentity(batch.nodeTransform);
+
+				batch.vertices.reserve(numVertices);
+				for (U32 i = 0; i < _numItems; i++)
+				{
+					appendTransformed(batch, _meshes[_items[i].mesh]);
+				}
+
+				_out.push_back(batch);
+				return;
+			}
+
+			// Median split along the axis the mesh centers spread the most
+			const base::Vec3 spread = base::sub(centerMax, centerMin);
+			const U32 axis = spread.x >= spread.y && spread.x >= spread.z ? 0 : (spread.y >= spread.z ? 1 : 2);
+			const U32 half = _numItems / 2;
+			std::nth_element(_items, _items + half, _items + _numItems, [axis](const BatchItem& _a, const BatchItem& _b)
+				{
+					const F32 a = axis == 0 ? _a.center.x : (axis == 1 ? _a.center.y : _a.center.z);
+					const F32 b = axis == 0 ? _b.center.x : (axis == 1 ? _b.center.y : _b.center.z);
+					return a < b;
+				});
+
+			splitBatch(_out, _meshes, _items, half, _maxVertices, _maxExtent);
+			splitBatch(_out, _meshes, _items + half, _numItems - half, _maxVertices, _maxExtent);
+		}
+
+	} // namespace
+
+	void batchStaticMeshes(std::vector<SceneMesh>& _out, const std::vector<SceneMesh>& _meshes, U32 _maxVertices,
+		F32 _maxExtent)
+	{
+		// Group by material, ordered map keeps the output deterministic
+		std::map<std::pair<std::string, U32>, std::vector<BatchItem> > groups;
+		for (U32 i = 0; i < _meshes.size(); i++)
+		{
+			BatchItem item;
+			item.mesh = i;
+			computeWorldBounds(item, _meshes[i]);
+			groups[std::make_pair(_meshes[i].materialPath, _meshes[i].texture)].push_back(item);
+		}
+
+		for (auto& group : groups)
+		{
+			splitBatch(_out, _meshes, group.second.data(), (U32)group.second.size(), _maxVertices, _maxExtent);
+		}
+	}
+
+	void splitLargeMeshes(std::vector<SceneMesh>& _meshes, U32 _maxVertices)
+	{
+		std::vector<SceneMesh> out;
+		out.reserve(_meshes.size());
+
+		std::vector<U32> remap; // Part vertex of every mesh vertex, UINT32_MAX if not in the current part
+		for (SceneMesh& mesh : _meshes)
+		{
+			if (mesh.vertices.size() <= _maxVertices)
+			{
+				out.push_back(std::move(mesh));
+				continue;
+			}
+
+			const bool hasSources = !mesh.sourceVertices.empty();
+			remap.assign(mesh.vertices.size(), UINT32_MAX);
+
+			SceneMesh* part = NULL;
+			U32 numParts = 0;
+			for (U32 i = 0; i + 2 < mesh.indices.size(); i += 3)
+			{
+				U32 numNew = 0;
+				for (U32 j = 0; j < 3; j++)
+				{
+					numNew += remap[mesh.indices[i + j]] == UINT32_MAX ? 1 : 0;
+				}
+
+				// Every part starts with the mesh's properties and none of its geometry
+				if (NULL == part || part->vertices.size() + numNew > _maxVertices)
+				{
+					std::fill(remap.begin(), remap.end(), UINT32_MAX);
+
+					out.emplace_back();
+					part = &out.back();
+					char suffix[32];
+					base::snprintf(suffix, sizeof(suffix), "_part%d", numParts++);
+					part->name = mesh.name + suffix;
+					part->materialPath = mesh.materialPath;
+					part->texture = mesh.texture;
+					part->textureArray = mesh.textureArray;
+					part->program = mesh.program;
+					part->material = mesh.material;
+					base::memCopy(part->transform, mesh.transform, sizeof(part->transform));
+					base::memCopy(part->nodeTransform, mesh.nodeTransform, sizeof(part->nodeTransform));
+					part->node = mesh.node;
+					part->morphTargets = mesh.morphTargets;
+					part->lodGroup = mesh.lodGroup;
+					part->lodLevel = mesh.lodLevel;
+					part->lodThreshold = mesh.lodThreshold;
+				}
+
+				for (U32 j = 0; j < 3; j++)
+				{
+					const U32 index = mesh.indices[i + j];
+					if (remap[index] == UINT32_MAX)
+					{
+						remap[index] = (U32)part->vertices.size();
+						part->vertices.push_back(mesh.vertices[index]);
+						if (hasSources)
+						{
+							part->sourceVertices.push_back(mesh.sourceVertices[index]);
+						}
+					}
+					part->indices.push_back(remap[index]);
+				}
+			}
+		}
+
+		_meshes.swap(out);
+	}
+
+} // namespace compiler
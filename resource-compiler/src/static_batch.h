@@ -0,0 +1,43 @@
+#pragma once
+
+#include "geometry.h"
+#include "morph_target.h"
+
+// std
+#include <string>
+#include <vector>
+
+namespace compiler
+{
+	// Mesh of a scene node ready to be written, before LODs and quantization.
+	struct SceneMesh
+	{
+		std::string name;
+		std::vector<MeshVertex> vertices;
+		std::vector<U32> indices;
+		std::string materialPath;
+		U32 texture; // Streamed texture index or pakx::kInvalidIndex
+		U32 textureArray; // Texture array index or pakx::kInvalidIndex
+		U16 program; // Index into the program table
+		U32 material; // Index into the material table
+		F32 transform[16]; // Mesh to world, row vector
+		F32 nodeTransform[16]; // Mesh to its node, row vector
+		U32 node; // Index into the prefab's nodes, pakx::kInvalidIndex if the mesh is in world space
+		std::vector<U32> sourceVertices; // FBX vertex of each vertex, only kept for meshes with morph targets
+		std::vector<MorphTarget> morphTargets;
+		U32 lodGroup; // Index of the FBX LOD group the mesh is a level of, pakx::kInvalidIndex if none
+		U32 lodLevel;
+		F32 lodThreshold;
+	};
+
+	// Merges static meshes sharing material and texture into batches with their transforms applied, so
+	// batches carry an identity transform. Every material group is split spatially at the median until a
+	// batch fits in _maxVertices and spans at most _maxExtent, keeping batches small enough to cull.
+	void batchStaticMeshes(std::vector<SceneMesh>& _out, const std::vector<SceneMesh>& _meshes, U32 _maxVertices,
+		F32 _maxExtent);
+
+	// Splits meshes with more than _maxVertices vertices into parts that fit, keeping the triangle order.
+	// Geometry has 16 bit indices, so no mesh may be written with more vertices than they can address.
+	void splitLargeMeshes(std::vector<SceneMesh>& _meshes, U32 _maxVertices);
+
+} // namespace compiler
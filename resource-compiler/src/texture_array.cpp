@@ -0,0 +1,86 @@
+#include "texture_array.h"
+#include "texture_stream.h"
+
+namespace compiler
+{
+	bool TextureArrayBuilder::addTexture(const U8* _rgba, U16 _width, U16 _height, U32* _outArray, U32* _outLayer)
+	{
+		if (_width == 0 || _height == 0)
+		{
+			return false;
+		}
+
+		// First array of the same size with a free layer
+		U32 arrayIndex = 0;
+		for (; arrayIndex < m_arrays.size(); arrayIndex++)
+		{
+			const pakx::TextureArray& info = m_arrays[arrayIndex].info;
+			if (info.width == _width && info.height == _height && info.numLayers < pakx::kMaxArrayLayers)
+			{
+				break;
+			}
+		}
+
+		if (arrayIndex == m_arrays.size())
+		{
+			Array array;
+			base::memSet(&array.info, 0, sizeof(array.info));
+			array.info.width = _width;
+			array.info.height = _height;
+			m_arrays.push_back(array);
+		}
+		Array& array = m_arrays[arrayIndex];
+
+		// Full mip chain, every layer of an array has the same number of mips
+		ChunkData mip(_rgba, _rgba + _width * _height * 4);
+		U32 width = _width;
+		U32 height = _height;
+		U8 numMips = 1;
+		array.data.insert(array.data.end(), mip.begin(), mip.end());
+		while (width > 1 || height > 1)
+		{
+			ChunkData next;
+			downsample(next, mip, width, height);
+			array.data.insert(array.data.end(), next.begin(), next.end());
+			mip.swap(next);
+
+			width = base::max<U32>(width / 2, 1);
+			height = base::max<U32>(height / 2, 1);
+			numMips++;
+		}
+
+		array.info.numMips = numMips;
+		*_outArray = arrayIndex;
+		*_outLayer = array.info.numLayers++;
+		return true;
+	}
+
+	ChunkData TextureArrayBuilder::serialize() const
+	{
+		ChunkData chunk;
+
+		pakx::TextureArraysHeader header;
+		header.numArrays = (U32)m_arrays.size();
+		header.reserved = 0;
+		chunkWrite(chunk, header);
+
+		U32 offset = (U32)(sizeof(pakx::TextureArraysHeader) + m_arrays.size() * sizeof(pakx::TextureArray));
+		for (const Array& array : m_arrays)
+		{
+			pakx::TextureArray info = array.info;
+			info.offset = offset;
+			info.size = (U32)array.data.size();
+			chunkWrite(chunk, info);
+
+			offset += info.size;
+		}
+
+		for (const Array& array : m_arrays)
+		{
+			chunkWrite(chunk, array.data.data(), (U32)array.data.size());
+		}
+
+		return chunk;
+	}
+
+} // namespace compiler
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "pakx_writer.h"
+
+namespace compiler
+{
+	// Packs textures of the same size into texture arrays with full mip chains, so materials only need
+	// to know their array and layer and many of them can share a single binding.
+	class TextureArrayBuilder
+	{
+	public:
+		// Takes RGBA8 data, returns false if the texture can't be added.
+		bool addTexture(const U8* _rgba, U16 _width, U16 _height, U32* _outArray, U32* _outLayer);
+		ChunkData serialize() const;
+
+		U32 getNumArrays() const { return (U32)m_arrays.size(); }
+
+	private:
+		struct Array
+		{
+			pakx::TextureArray info;
+			ChunkData data; // All mips of every layer
+		};
+
+		std::vector<Array> m_arrays;
+	};
+
+} // namespace compiler
@@ -0,0 +1,106 @@
+#include "texture_stream.h"
+
+namespace compiler
+{
+	void downsample(ChunkData& _dst, const ChunkData& _src, U32 _srcWidth, U32 _srcHeight)
+	{
+		const U32 dstWidth = base::max<U32>(_srcWidth / 2, 1);
+		const U32 dstHeight = base::max<U32>(_srcHeight / 2, 1);
+		_dst.resize(dstWidth * dstHeight * 4);
+
+		for (U32 y = 0; y < dstHeight; y++)
+		{
+			const U32 y0 = base::min<U32>(y * 2 + 0, _srcHeight - 1);
+			const U32 y1 = base::min<U32>(y * 2 + 1, _srcHeight - 1);
+
+			for (U32 x = 0; x < dstWidth; x++)
+			{
+				const U32 x0 = base::min<U32>(x * 2 + 0, _srcWidth - 1);
+				const U32 x1 = base::min<U32>(x * 2 + 1, _srcWidth - 1);
+
+				const U8* p00 = &_src[(y0 * _srcWidth + x0) * 4];
+				const U8* p01 = &_src[(y0 * _srcWidth + x1) * 4];
+				const U8* p10 = &_src[(y1 * _srcWidth + x0) * 4];
+				const U8* p11 = &_src[(y1 * _srcWidth + x1) * 4];
+
+				U8* dst = &_dst[(y * dstWidth + x) * 4];
+				for (U32 c = 0; c < 4; c++)
+				{
+					dst[c] = (U8)((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+				}
+			}
+		}
+	}
+
+	U32 TextureStreamBuilder::addTexture(const base::FilePath& _vfp, const U8* _rgba, U16 _width, U16 _height)
+	{
+		Texture texture;
+		base::memSet(&texture.info, 0, sizeof(texture.info));
+		texture.info.vfpHash = pakx::hashVfp(_vfp.getCPtr());
+		texture.info.width = _width;
+		texture.info.height = _height;
+
+		// Mip 0 is the source image
+		texture.mips.push_back(ChunkData(_rgba, _rgba + _width * _height * 4));
+
+		U32 width = _width;
+		U32 height = _height;
+		while ((width > 1 || height > 1) && texture.mips.size() < pakx::kMaxMips)
+		{
+			ChunkData mip;
+			downsample(mip, texture.mips.back(), width, height);
+			texture.mips.push_back(mip);
+
+			width = base::max<U32>(width / 2, 1);
+			height = base::max<U32>(height / 2, 1);
+		}
+		texture.info.numMips = (U8)texture.mips.size();
+
+		// Tail starts at the first mip that fits in kTailSize
+		U8 tailMip = 0;
+		while (tailMip < texture.info.numMips - 1 &&
+			base::max<U32>(_width >> tailMip, _height >> tailMip) > kTailSize)
+		{
+			tailMip++;
+		}
+		texture.info.tailMip = tailMip;
+
+		m_textures.push_back(texture);
+		return (U32)m_textures.size() - 1;
+	}
+
+	ChunkData TextureStreamBuilder::serialize() const
+	{
+		ChunkData chunk;
+
+		pakx::TexturesHeader header;
+		header.numTextures = (U32)m_textures.size();
+		header.reserved = 0;
+		chunkWrite(chunk, header);
+
+		// Resolve mip offsets relative to chunk start
+		U32 offset = (U32)(sizeof(pakx::TexturesHeader) + m_textures.size() * sizeof(pakx::StreamTexture));
+		for (const Texture& texture : m_textures)
+		{
+			pakx::StreamTexture info = texture.info;
+			for (U32 i = 0; i < texture.mips.size(); i++)
+			{
+				info.mipOffset[i] = offset;
+				info.mipSize[i] = (U32)texture.mips[i].size();
+				offset += info.mipSize[i];
+			}
+			chunkWrite(chunk, info);
+		}
+
+		for (const Texture& texture : m_textures)
+		{
+			for (const ChunkData& mip : texture.mips)
+			{
+				chunkWrite(chunk, mip.data(), (U32)mip.size());
+			}
+		}
+
+		return chunk;
+	}
+
+} // namespace compiler
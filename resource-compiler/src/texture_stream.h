@@ -0,0 +1,33 @@
+#pragma once
+
+#include "pakx_writer.h"
+
+namespace compiler
+{
+	// 2x2 box filter of RGBA8 data, odd edges are clamped.
+	void downsample(ChunkData& _dst, const ChunkData& _src, U32 _srcWidth, U32 _srcHeight);
+
+	// Builds the full mip chain of every streamed texture and serializes them into the textures chunk.
+	// Mips up to kTailSize are marked as the tail, the runtime keeps those resident at all times.
+	class TextureStreamBuilder
+	{
+	public:
+		static constexpr U32 kTailSize = 64;
+
+		// Takes RGBA8 data, returns index of texture inside the chunk.
+		U32 addTexture(const base::FilePath& _vfp, const U8* _rgba, U16 _width, U16 _height);
+		ChunkData serialize() const;
+
+		U32 getNumTextures() const { return (U32)m_textures.size(); }
+
+	private:
+		struct Texture
+		{
+			pakx::StreamTexture info;
+			std::vector<ChunkData> mips;
+		};
+
+		std::vector<Texture> m_textures;
+	};
+
+} // namespace compiler
@@ -0,0 +1,314 @@
+#include "throughput_benchmark.h"
+
+// std
+#include <cstdlib>
+#include <cstring>
+
+#if BASE_PLATFORM_POSIX
+#	include <fcntl.h>
+#	include <sys/resource.h>
+#	include <unistd.h>
+#endif // BASE_PLATFORM_POSIX
+
+namespace compiler
+{
+	namespace
+	{
+		constexpr U32 kFlushSize = 1 << 20;
+
+		F64 toMs(I64 _ticks)
+		{
+			return F64(_ticks) * 1000.0 / F64(base::getHPFrequency());
+		}
+
+		void writeText(base::FileWriter& _writer, const char* _text, base::Error* _err)
+		{
+			base::write(&_writer, _text, (I32)std::strlen(_text), _err);
+		}
+
+		void writeString(base::FileWriter& _writer, const char* _string, base::Error* _err)
+		{
+			base::write(&_writer, "\"", 1, _err);
+			for (const char* c = _string; *c != '\0'; c++)
+			{
+				if (*c == '"' || *c == '\\')
+				{
+					base::write(&_writer, "\\", 1, _err);
+				}
+				base::write(&_writer, c, 1, _err);
+			}
+			base::write(&_writer, "\"", 1, _err);
+		}
+
+		// Text is gathered and written in large blocks, generated meshes reach hundreds of MB
+		void append(std::string& _buffer, base::FileWriter& _writer, const char* _text, I32 _len, base::Error* _err)
+		{
+			_buffer.append(_text, (size_t)_len);
+			if (_buffer.size() >= kFlushSize)
+			{
+				base::write(&_writer, _buffer.data(), (I32)_buffer.size(), _err);
+				_buffer.clear();
+			}
+		}
+
+		F64 perSecond(F64 _amount, F64 _ms)
+		{
+			return _ms > 0.0 ? _amount * 1000.0 / _ms : 0.0;
+		}
+
+	} // namespace
+
+	bool writeGridMesh(const char* _path, U32 _numTriangles)
+	{
+		base::FileWriter writer;
+		base::Error err;
+		if (!base::open(&writer, _path, false, &err))
+		{
+			BASE_TRACE("Failed: Opening %s for writing", _path)
+			return false;
+		}
+
+		// Two triangles per cell, as square as the count allows
+		const U32 numCells = (_numTriangles + 1) / 2;
+		const U32 width = base::max<U32>((U32)base::ceil(base::sqrt(F32(numCells))), 1);
+		const U32 height = (numCells + width - 1) / width;
+
+		std::string buffer;
+		buffer.reserve(kFlushSize + 256);
+
+		char line[256];
+		I32 len = base::snprintf(line, sizeof(line), "# %u triangle grid\nvn 0 1 0\n", _numTriangles);
+		append(buffer, writer, line, len, &err);
+		for (U32 y = 0; y <= height; y++)
+		{
+			for (U32 x = 0; x <= width; x++)
+			{
+				const F32 u = F32(x) / F32(width);
+				const F32 v = F32(y) / F32(height);
+				len = base::snprintf(line, sizeof(line), "v %.4f 0 %.4f\nvt %.5f %.5f\n", u * 100.0f, v * 100.0f, u, v);
+				append(buffer, writer, line, len, &err);
+			}
+		}
+
+		U32 numTriangles = 0;
+		for (U32 cell = 0; numTriangles < _numTriangles; cell++)
+		{
+			// Indices are 1 based, positions and UVs share them
+			const U32 a = (cell / width) * (width + 1) + cell % width + 1;
+			const U32 b = a + 1;
+			const U32 c = a + width + 1;
+			const U32 d = c + 1;
+
+			len = base::snprintf(line, sizeof(line), "f %u/%u/1 %u/%u/1 %u/%u/1\n", a, a, c, c, b, b);
+			append(buffer, writer, line, len, &err);
+			numTriangles++;
+
+			if (numTriangles < _numTriangles)
+			{
+				len = base::snprintf(line, sizeof(line), "f %u/%u/1 %u/%u/1 %u/%u/1\n", b, b, c, c, d, d);
+				append(buffer, writer, line, len, &err);
+				numTriangles++;
+			}
+		}
+
+		base::write(&writer, buffer.data(), (I32)buffer.size(), &err);
+		base::close(&writer);
+
+		return err.isOk();
+	}
+
+	bool writeNoiseTexture(const char* _path, U32 _size)
+	{
+		base::FileWriter writer;
+		base::Error err;
+		if (!base::open(&writer, _path, false, &err))
+		{
+			BASE_TRACE("Failed: Opening %s for writing", _path)
+			return false;
+		}
+
+		// Uncompressed true color, 8 bits of alpha, rows bottom up
+		U8 header[18] = {};
+		header[2] = 2;
+		header[12] = U8(_size & 0xff);
+		header[13] = U8(_size >> 8);
+		header[14] = U8(_size & 0xff);
+		header[15] = U8(_size >> 8);
+		header[16] = 32;
+		header[17] = 8;
+		base::write(&writer, header, sizeof(header), &err);
+
+		// Xorshift, the same texture on every run
+		std::vector<U32> row(_size);
+		U32 state = 0x9e3779b9u;
+		for (U32 y = 0; y < _size; y++)
+		{
+			for (U32 x = 0; x < _size; x++)
+			{
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+				row[x] = state | 0xff000000u;
+			}
+			base::write(&writer, row.data(), (I32)(_size * sizeof(U32)), &err);
+		}
+
+		base::close(&writer);
+
+		return err.isOk();
+	}
+
+	void resetPeakMemory()
+	{
+#if BASE_PLATFORM_LINUX
+		// Writing 5 resets the high water mark of the resident set
+		const int fd = ::open("/proc/self/clear_refs", O_WRONLY);
+		if (fd >= 0)
+		{
+			const ssize_t written = ::write(fd, "5", 1);
+			BASE_UNUSED(written);
+			::close(fd);
+		}
+#endif // BASE_PLATFORM_LINUX
+	}
+
+	U64 getPeakMemory()
+	{
+#if BASE_PLATFORM_LINUX
+		const int fd = ::open("/proc/self/status", O_RDONLY);
+		if (fd >= 0)
+		{
+			char status[4096];
+			const ssize_t size = ::read(fd, status, sizeof(status) - 1);
+			::close(fd);
+
+			status[base::max<ssize_t>(size, 0)] = '\0';
+			const char* hwm = std::strstr(status, "VmHWM:");
+			if (NULL != hwm)
+			{
+				return U64(std::strtoull(hwm + 6, NULL, 10)) * 1024;
+			}
+		}
+#endif // BASE_PLATFORM_LINUX
+
+#if BASE_PLATFORM_POSIX
+		struct rusage usage;
+		if (0 == getrusage(RUSAGE_SELF, &usage))
+		{
+#	if BASE_PLATFORM_OSX
+			return U64(usage.ru_maxrss);
+#	else
+			return U64(usage.ru_maxrss) * 1024;
+#	endif // BASE_PLATFORM_OSX
+		}
+#endif // BASE_PLATFORM_POSIX
+
+		return 0;
+	}
+
+	ThroughputBenchmark::ThroughputBenchmark(const BuildReport& _report)
+		: m_report(_report)
+		, m_firstAsset(0)
+		, m_start(0)
+	{}
+
+	void ThroughputBenchmark::begin(const char* _name, const char* _type)
+	{
+		ThroughputResult result;
+		result.name = _name;
+		result.type = _type;
+		result.totalMs = 0.0;
+		for (U32 i = 0; i < BuildStage::Count; i++)
+		{
+			result.stageMs[i] = 0.0;
+		}
+		result.inputBytes = 0;
+		result.outputBytes = 0;
+		result.numTriangles = 0;
+		result.numAllocations = 0;
+		result.peakBytes = 0;
+		m_results.push_back(result);
+
+		resetPeakMemory();
+		m_firstAsset = m_report.getNumAssets();
+		m_start = base::getHPCounter();
+	}
+
+	void ThroughputBenchmark::end()
+	{
+		ThroughputResult& result = m_results.back();
+		result.totalMs = toMs(base::getHPCounter() - m_start);
+		result.peakBytes = getPeakMemory();
+
+		for (U32 i = m_firstAsset; i < m_report.getNumAssets(); i++)
+		{
+			const AssetReport& asset = m_report.getAsset(i);
+			for (U32 j = 0; j < BuildStage::Count; j++)
+			{
+				result.stageMs[j] += asset.stageMs[j];
+			}
+			result.inputBytes += asset.inputBytes;
+			result.outputBytes += asset.outputBytes;
+			result.numTriangles += asset.numTriangles;
+			result.numAllocations += asset.numAllocations;
+		}
+	}
+
+	bool ThroughputBenchmark::writeJson(const base::FilePath& _filePath) const
+	{
+		base::FileWriter writer;
+		base::Error err;
+		if (!base::open(&writer, _filePath, false, &err))
+		{
+			BASE_TRACE("Failed: Opening %s for writing", _filePath.getCPtr())
+			return false;
+		}
+
+		writeText(writer, "{\n\t\"results\": [", &err);
+
+		char line[512];
+		for (U32 i = 0; i < m_results.size(); i++)
+		{
+			const ThroughputResult& result = m_results[i];
+
+			writeText(writer, i > 0 ? ",\n\t\t{ \"name\": " : "\n\t\t{ \"name\": ", &err);
+			writeString(writer, result.name.c_str(), &err);
+			writeText(writer, ", \"type\": ", &err);
+			writeString(writer, result.type.c_str(), &err);
+
+			I32 len = base::snprintf(line, sizeof(line), ", \"totalMs\": %.3f, \"stageMs\": {", result.totalMs);
+			base::write(&writer, line, len, &err);
+			for (U32 j = 0; j < BuildStage::Count; j++)
+			{
+				len = base::snprintf(line, sizeof(line), "%s\"%s\": %.3f", j > 0 ? ", " : " ",
+					getStageName((BuildStage::Enum)j), result.stageMs[j]);
+				base::write(&writer, line, len, &err);
+			}
+
+			len = base::snprintf(line, sizeof(line), " }, \"inputBytes\": %llu, \"outputBytes\": %llu, \"triangles\": %llu, "
+				"\"trianglesPerSecond\": %.0f, \"inputMBps\": %.2f, \"outputMBps\": %.2f, \"allocations\": %llu, \"peakBytes\": %llu }",
+				(unsigned long long)result.inputBytes, (unsigned long long)result.outputBytes, (unsigned long long)result.numTriangles,
+				perSecond(F64(result.numTriangles), result.totalMs), perSecond(F64(result.inputBytes) / (1 << 20), result.totalMs),
+				perSecond(F64(result.outputBytes) / (1 << 20), result.totalMs), (unsigned long long)result.numAllocations,
+				(unsigned long long)result.peakBytes);
+			base::write(&writer, line, len, &err);
+		}
+
+		writeText(writer, "\n\t]\n}\n", &err);
+		base::close(&writer);
+
+		return err.isOk();
+	}
+
+	void ThroughputBenchmark::printSummary() const
+	{
+		for (const ThroughputResult& result : m_results)
+		{
+			BASE_TRACE("%10.1f ms %-8s %s, %.0f triangles/s, %.1f MB/s in, %.1f MB/s out, peak %.1f MB", result.totalMs,
+				result.type.c_str(), result.name.c_str(), perSecond(F64(result.numTriangles), result.totalMs),
+				perSecond(F64(result.inputBytes) / (1 << 20), result.totalMs), perSecond(F64(result.outputBytes) / (1 << 20), result.totalMs),
+				F64(result.peakBytes) / (1 << 20))
+		}
+	}
+
+} // namespace compiler
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "build_report.h"
+
+#ifndef COMPILER_CONFIG_BENCHMARK
+#	define COMPILER_CONFIG_BENCHMARK 0
+#endif // COMPILER_CONFIG_BENCHMARK
+
+namespace compiler
+{
+	// Writes a flat grid as an .obj with exactly _numTriangles triangles, positions, UVs and normals.
+	bool writeGridMesh(const char* _path, U32 _numTriangles);
+
+	// Writes an uncompressed 32 bit .tga of noise, which no encoder can shortcut.
+	bool writeNoiseTexture(const char* _path, U32 _size);
+
+	// Largest resident set of the process since the last reset, 0 where the platform can't tell.
+	// Resetting needs Linux, elsewhere the peak covers the whole run.
+	void resetPeakMemory();
+	U64 getPeakMemory();
+
+	struct ThroughputResult
+	{
+		std::string name;
+		std::string type;
+		F64 totalMs; // Wall time of the input
+		F64 stageMs[BuildStage::Count]; // Summed over every asset the input imported
+		U64 inputBytes;
+		U64 outputBytes;
+		U64 numTriangles;
+		U64 numAllocations;
+		U64 peakBytes;
+	};
+
+	// Throughput of the importers for the benchmark build (COMPILER_CONFIG_BENCHMARK). Every input
+	// collects the assets the build report recorded while it ran, textures imported by a scene count
+	// towards the scene.
+	class ThroughputBenchmark
+	{
+	public:
+		explicit ThroughputBenchmark(const BuildReport& _report);
+
+		void begin(const char* _name, const char* _type);
+		void end();
+
+		bool writeJson(const base::FilePath& _filePath) const;
+		void printSummary() const;
+
+	private:
+		const BuildReport& m_report;
+		std::vector<ThroughputResult> m_results;
+		U32 m_firstAsset;
+		I64 m_start;
+	};
+
+} // namespace compiler
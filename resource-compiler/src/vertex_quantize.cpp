@@ -0,0 +1,129 @@
+#include "vertex_quantize.h"
+
+namespace compiler
+{
+	namespace
+	{
+		I16 quantizeSnorm16(F32 _value)
+		{
+			return (I16)base::round(base::clamp(_value, -1.0f, 1.0f) * 32767.0f);
+		}
+
+		U8 quantizeUnorm8(F32 _value)
+		{
+			return (U8)base::round(base::clamp(_value * 0.5f + 0.5f, 0.0f, 1.0f) * 255.0f);
+		}
+
+		void encodeOctahedral(F32* _result, F32 _x, F32 _y, F32 _z)
+		{
+			const F32 sum = base::abs(_x) + base::abs(_y) + base::abs(_z);
+			F32 x = sum > 0.0f ? _x / sum : 0.0f;
+			F32 y = sum > 0.0f ? _y / sum : 0.0f;
+
+			// Fold lower hemisphere over the diagonals
+			if (_z < 0.0f)
+			{
+				const F32 fx = (1.0f - base::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+				const F32 fy = (1.0f - base::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+				x = fx;
+				y = fy;
+			}
+
+			_result[0] = x;
+			_result[1] = y;
+		}
+
+	} // namespace
+
+	void quantizeVertices(QuantizedVertices& _out, const std::vector<MeshVertex>& _vertices, U32 _normalBits)
+	{
+		// Quantization range is the AABB center and its largest half extent, using one scale for all
+		// axes keeps the dequantization a uniform scale that bounds and normals survive.
+		base::Vec3 min = { base::kFloatMax, base::kFloatMax, base::kFloatMax };
+		base::Vec3 max = { -base::kFloatMax, -base::kFloatMax, -base::kFloatMax };
+		for (const MeshVertex& vertex : _vertices)
+		{
+			min = base::min(min, { vertex.x, vertex.y, vertex.z });
+			max = base::max(max, { vertex.x, vertex.y, vertex.z });
+		}
+		const base::Vec3 center = base::mul(base::add(min, max), 0.5f);
+		const base::Vec3 extent = base::mul(base::sub(max, min), 0.5f);
+		const F32 scale = base::max(base::max(extent.x, extent.y), base::max(extent.z, 1e-6f));
+
+		_out.dequantScale = scale;
+		_out.dequantBias[0] = center.x;
+		_out.dequantBias[1] = center.y;
+		_out.dequantBias[2] = center.z;
+
+		// Position is padded to 4 components, 3 component 16-bit formats don't exist on all backends
+		_out.layout.begin()
+			.add(graphics::Attrib::Position, 4, graphics::AttribType::Int16, true)
+			.add(graphics::Attrib::TexCoord0, 2, graphics::AttribType::Half);
+		if (_normalBits == 8)
+		{
+			_out.layout
+				.add(graphics::Attrib::Normal, 2, graphics::AttribType::Uint8, true)
+				.skip(2);
+		}
+		else
+		{
+			_out.layout.add(graphics::Attrib::Normal, 2, graphics::AttribType::Int16, true);
+		}
+		_out.layout.end();
+
+		const U16 stride = _out.layout.getStride();
+		_out.data.resize(_vertices.size() * stride);
+
+		const F32 invScale = 1.0f / scale;
+		for (size_t i = 0; i < _vertices.size(); i++)
+		{
+			const MeshVertex& vertex = _vertices[i];
+			U8* dst = &_out.data[i * stride];
+
+			I16 position[4] =
+			{
+				quantizeSnorm16((vertex.x - center.x) * invScale),
+				quantizeSnorm16((vertex.y - center.y) * invScale),
+				quantizeSnorm16((vertex.z - center.z) * invScale),
+				32767,
+			};
+			base::memCopy(dst, position, sizeof(position));
+			dst += sizeof(position);
+
+			U16 uv[2] = { base::halfFromFloat(vertex.u), base::halfFromFloat(vertex.v) };
+			base::memCopy(dst, uv, sizeof(uv));
+			dst += sizeof(uv);
+
+			F32 octahedral[2];
+			encodeOctahedral(octahedral, vertex.nx, vertex.ny, vertex.nz);
+			if (_normalBits == 8)
+			{
+				U8 normal[4] = { quantizeUnorm8(octahedral[0]), quantizeUnorm8(octahedral[1]), 0, 0 };
+				base::memCopy(dst, normal, sizeof(normal));
+			}
+			else
+			{
+				I16 normal[2] = { quantizeSnorm16(octahedral[0]), quantizeSnorm16(octahedral[1]) };
+				base::memCopy(dst, normal, sizeof(normal));
+			}
+		}
+	}
+
+	void applyDequantization(F32* _mtx, const QuantizedVertices& _quantized)
+	{
+		// Row vector convention, dequantize first: result = Dequant * _mtx
+		const F32 scale = _quantized.dequantScale;
+		const F32* bias = _quantized.dequantBias;
+
+		F32 result[16];
+		for (U32 col = 0; col < 4; col++)
+		{
+			result[0 + col] = scale * _mtx[0 + col];
+			result[4 + col] = scale * _mtx[4 + col];
+			result[8 + col] = scale * _mtx[8 + col];
+			result[12 + col] = bias[0] * _mtx[0 + col] + bias[1] * _mtx[4 + col] + bias[2] * _mtx[8 + col] + _mtx[12 + col];
+		}
+		base::memCopy(_mtx, result, sizeof(result));
+	}
+
+} // namespace compiler
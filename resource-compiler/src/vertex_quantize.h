@@ -0,0 +1,31 @@
+#pragma once
+
+#include "geometry.h"
+
+// std
+#include <vector>
+
+namespace compiler
+{
+	struct QuantizedVertices
+	{
+		std::vector<U8> data;
+		graphics::VertexLayout layout;
+
+		// Dequantization: position = dequantBias + normalizedPosition * dequantScale
+		F32 dequantScale;
+		F32 dequantBias[3];
+	};
+
+	// Packs vertices into a compact layout:
+	// - Position: 16-bit normalized, relative to the center and largest half extent of the AABB.
+	// - UV: half float.
+	// - Normal: octahedral encoded into 2x8 (unorm) or 2x16 (snorm) bits. Shaders decode with
+	//   decodeNormalOctahedron() from shaderlib.sh, remapping snorm input with * 0.5 + 0.5 first.
+	void quantizeVertices(QuantizedVertices& _out, const std::vector<MeshVertex>& _vertices, U32 _normalBits);
+
+	// Applies the dequantization in front of a mesh transform, so quantized positions need no extra
+	// work in the vertex shader.
+	void applyDequantization(F32* _mtx, const QuantizedVertices& _quantized);
+
+} // namespace compiler
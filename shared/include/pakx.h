@@ -0,0 +1,341 @@
+#pragma once
+
+#include <base/hash.h>
+
+// PAK extension (.pakx)
+//
+// Sidecar file written by the resource compiler next to the engine PAK. It carries data the engine
+// resource formats have no room for. The file is a flat list of chunks identified by a fourcc, every
+// offset stored inside a chunk is relative to the start of that chunk.
+namespace pakx
+{
+	constexpr U32 kMagic = BASE_MAKEFOURCC('P', 'A', 'K', 'X');
+	constexpr U32 kVersion = 11;
+
+	constexpr U32 kChunkTextures = BASE_MAKEFOURCC('T', 'E', 'X', 'S');
+	constexpr U32 kChunkPrefabs = BASE_MAKEFOURCC('P', 'R', 'F', 'B');
+	constexpr U32 kChunkMeshlets = BASE_MAKEFOURCC('M', 'S', 'H', 'L');
+	constexpr U32 kChunkPrograms = BASE_MAKEFOURCC('P', 'R', 'O', 'G');
+	constexpr U32 kChunkMaterials = BASE_MAKEFOURCC('M', 'A', 'T', 'L');
+	constexpr U32 kChunkTextureArrays = BASE_MAKEFOURCC('T', 'E', 'X', 'A');
+	constexpr U32 kChunkResources = BASE_MAKEFOURCC('R', 'S', 'R', 'C');
+	constexpr U32 kChunkMorphs = BASE_MAKEFOURCC('M', 'R', 'P', 'H');
+	constexpr U32 kChunkNodes = BASE_MAKEFOURCC('N', 'O', 'D', 'E');
+
+	constexpr U32 kInvalidIndex = UINT32_MAX;
+
+	struct Header
+	{
+		U32 magic;
+		U32 version;
+		U32 numChunks;
+		U32 reserved;
+	};
+
+	struct Chunk
+	{
+		U32 fourcc;
+		U32 reserved;
+		U64 offset; // From start of file
+		U64 size;
+	};
+
+	// Textures chunk
+	//
+	// [TexturesHeader][StreamTexture * numTextures][Mip data]
+	// Mips are stored largest first, all RGBA8.
+	constexpr U32 kMaxMips = 16;
+
+	struct TexturesHeader
+	{
+		U32 numTextures;
+		U32 reserved;
+	};
+
+	struct StreamTexture
+	{
+		U32 vfpHash;
+		U16 width;
+		U16 height;
+		U8 numMips;
+		U8 tailMip; // First mip that is always resident
+		U16 reserved;
+		U32 mipOffset[kMaxMips];
+		U32 mipSize[kMaxMips];
+	};
+
+	// Prefabs chunk
+	//
+	// [PrefabsHeader][Prefab * numPrefabs][Mesh * numMeshes]
+	// Meshes of a prefab are stored in the same order as the prefab's mesh paths. LOD levels of a mesh
+	// follow each other, starting at level 0. Levels are either simplified by the compiler and picked by
+	// their error, or authored as an FBX LOD group and picked by their threshold.
+	//
+	// Meshes are split over engine prefabs of at most kMaxPartMeshes meshes. Part 0 is the prefab itself,
+	// further parts add _partN to its path, see getPartPath. Mesh records cover all parts in order.
+	constexpr U32 kMaxPartMeshes = 100;
+
+	constexpr U32 kLodAuthored = 1 << 0; // Levels come from an LOD group, lodThreshold is set
+	constexpr U32 kLodScreenPercent = 1 << 1; // Thresholds are screen size percentages, not distances
+
+	struct PrefabsHeader
+	{
+		U32 numPrefabs;
+		U32 numMeshes;
+	};
+
+	struct Prefab
+	{
+		U32 vfpHash;
+		U32 firstMesh;
+		U32 numMeshes;
+		U32 numParts;
+		U32 nodeOffset; // Offset of the prefab's nodes in the nodes chunk
+		U32 numNodes;
+		U32 contentHash; // Source files, compiler settings, materials and shaders of the prefab, unchanged unless they are
+	};
+
+	struct Mesh
+	{
+		F32 center[3]; // Bounding sphere in mesh space
+		F32 radius;
+		U32 texture; // Index into textures chunk, kInvalidIndex if untextured
+		U8 lod; // LOD level of this mesh
+		U8 numLods; // Number of LOD levels of the mesh this level belongs to
+		U16 program; // Index into programs chunk
+
+		F32 lodError; // Simplification error relative to the bounding radius of level 0
+		U32 firstMeshlet; // Range in the meshlets chunk, numMeshlets is 0 if the mesh has none
+		U32 numMeshlets;
+		U32 material; // Index into materials chunk
+		U32 textureArray; // Index into texture arrays chunk, kInvalidIndex if none
+		U32 firstMorphTarget; // Range in the morphs chunk, numMorphTargets is 0 if the mesh has none
+		U32 numMorphTargets;
+		F32 lodThreshold; // Authored levels: min distance to the camera, or max screen size with kLodScreenPercent
+		U32 lodFlags; // Same for every level of a mesh
+		U32 node; // Index into the prefab's nodes, kInvalidIndex if the mesh is in prefab space
+	};
+
+	inline void getPartPath(char* _out, U32 _max, const char* _vfp, U32 _part)
+	{
+		// Part number goes in front of the extension, "scenes/scene.bin" -> "scenes/scene_part1.bin"
+		U32 len = 0;
+		U32 extension = UINT32_MAX;
+		for (; _vfp[len] != '\0'; len++)
+		{
+			extension = _vfp[len] == '.' ? len : (_vfp[len] == '/' ? UINT32_MAX : extension);
+		}
+		extension = extension == UINT32_MAX ? len : extension;
+
+		char suffix[16] = "_part";
+		U32 suffixLen = 5;
+		char digits[10];
+		U32 numDigits = 0;
+		do
+		{
+			digits[numDigits++] = char('0' + _part % 10);
+			_part /= 10;
+		} while (_part > 0);
+		while (numDigits > 0)
+		{
+			suffix[suffixLen++] = digits[--numDigits];
+		}
+
+		U32 pos = 0;
+		for (U32 i = 0; i < extension && pos + 1 < _max; i++)
+		{
+			_out[pos++] = _vfp[i];
+		}
+		for (U32 i = 0; i < suffixLen && pos + 1 < _max; i++)
+		{
+			_out[pos++] = suffix[i];
+		}
+		for (U32 i = extension; i < len && pos + 1 < _max; i++)
+		{
+			_out[pos++] = _vfp[i];
+		}
+		_out[pos] = '\0';
+	}
+
+	// Nodes chunk
+	//
+	// [NodesHeader][per prefab: U32 parent * numNodes][F32 translation * 3 * numNodes]
+	//     [F32 rotation * 4 * numNodes][F32 scale * 3 * numNodes]
+	// Node hierarchy of every prefab in breadth-first order, so a parent always comes before its children
+	// and world transforms resolve in one pass. Parents are prefab-local indices, kInvalidIndex for
+	// roots. Transforms are local to the parent, rotations are quaternions (x, y, z, w). The transform
+	// arrays of a prefab follow each other so an instance copies them at once.
+	struct NodesHeader
+	{
+		U32 numNodes;
+		U32 reserved;
+	};
+
+	// Meshlets chunk
+	//
+	// [MeshletsHeader][Meshlet * numMeshlets][U32 vertices * numVertices][U8 triangles * numTriangles * 3]
+	// Meshlet triangles are contiguous in the geometry index buffer starting at firstIndex. Vertices
+	// index into the geometry vertex buffer, triangles index into the meshlet's own vertex list.
+	constexpr U32 kMaxMeshletVertices = 64;
+	constexpr U32 kMaxMeshletTriangles = 124;
+
+	struct MeshletsHeader
+	{
+		U32 numMeshlets;
+		U32 numVertices;
+		U32 numTriangles;
+		U32 reserved;
+	};
+
+	struct Meshlet
+	{
+		F32 center[3]; // Bounding sphere in mesh space
+		F32 radius;
+		F32 coneAxis[3]; // Normal cone, the meshlet faces away from viewers inside the cone
+		F32 coneCutoff;
+		U32 firstIndex;
+		U32 vertexOffset;
+		U32 triangleOffset;
+		U8 numVertices;
+		U8 numTriangles;
+		U16 reserved;
+	};
+
+	// Programs chunk
+	//
+	// [ProgramsHeader][ProgramShader * numShaders][Program * numPrograms][bytecode]
+	// Every unique vertex/fragment shader pair used by a material, with the bytecode of each shader stored
+	// once. Bytecode offsets are relative to the start of the chunk.
+	struct ProgramsHeader
+	{
+		U32 numShaders;
+		U32 numPrograms;
+	};
+
+	struct ProgramShader
+	{
+		U32 vfpHash;
+		U32 offset;
+		U32 size;
+		U32 reserved;
+	};
+
+	struct Program
+	{
+		U32 vertexShader; // Index into program shaders
+		U32 fragmentShader;
+	};
+
+	// Materials chunk
+	//
+	// [MaterialsHeader][MaterialBlock * numMaterials]
+	// All uniforms of a material packed into one vec4 aligned block, uploaded as the u_material array.
+	constexpr U32 kMaterialBlockVec4s = 2;
+
+	struct MaterialsHeader
+	{
+		U32 numMaterials;
+		U32 numVec4s; // Size of a block, kMaterialBlockVec4s
+	};
+
+	struct MaterialBlock
+	{
+		F32 diffuse[4]; // u_material[0]
+		F32 alphaCutoff; // u_material[1].x
+		F32 textureLayer; // u_material[1].y, layer inside the mesh's texture array
+		F32 reserved[2];
+	};
+
+	// Texture arrays chunk
+	//
+	// [TextureArraysHeader][TextureArray * numArrays][data]
+	// Textures of the same size packed into RGBA8 arrays with full mip chains. Data of an array is
+	// stored layer by layer with all mips of a layer, largest first. Offsets are chunk-relative.
+	constexpr U32 kMaxArrayLayers = 256;
+
+	struct TextureArraysHeader
+	{
+		U32 numArrays;
+		U32 reserved;
+	};
+
+	struct TextureArray
+	{
+		U16 width;
+		U16 height;
+		U16 numLayers;
+		U8 numMips;
+		U8 reserved;
+		U32 offset;
+		U32 size;
+	};
+
+	// Morphs chunk
+	//
+	// [MorphsHeader][MorphTarget * numTargets][MorphDelta * numDeltas]
+	// Blend shapes stored as only the vertices each shape moves. Deltas are in the space of the geometry's
+	// positions, quantized space if the geometry is quantized, and stored as 16 bits scaled per target.
+	struct MorphsHeader
+	{
+		U32 numTargets;
+		U32 numDeltas;
+	};
+
+	struct MorphTarget
+	{
+		U32 nameHash; // Hash of the blend channel name
+		U32 firstDelta;
+		U32 numDeltas;
+		F32 scale; // Position delta = MorphDelta::position * scale
+	};
+
+	struct MorphDelta
+	{
+		U32 vertex; // Index into the geometry vertex buffer
+		I16 position[3];
+		I16 reserved;
+	};
+
+	// Resources chunk
+	//
+	// [ResourcesHeader][Resource * numResources]
+	// Size of every resource in the PAK, used for memory accounting at runtime. CPU bytes are what the
+	// engine keeps in memory, GPU bytes what the renderer allocates when the resource is created.
+	struct ResourceType
+	{
+		enum Enum : U8
+		{
+			Geometry,
+			Texture,
+			Material,
+			Shader,
+			Mesh,
+			Prefab,
+
+			Count
+		};
+	};
+
+	struct ResourcesHeader
+	{
+		U32 numResources;
+		U32 reserved;
+	};
+
+	struct Resource
+	{
+		U32 vfpHash;
+		U8 type; // ResourceType
+		U8 reserved[3];
+		U32 cpuBytes;
+		U32 gpuBytes;
+	};
+
+	inline U32 hashVfp(const char* _vfp)
+	{
+		U32 len = 0;
+		while (_vfp[len] != '\0') len++;
+		return base::hash<base::HashMurmur2A>(_vfp, len);
+	}
+
+} // namespace pakx